@@ -0,0 +1,72 @@
+//counts heap allocations made by the treewalk interpreter while it evaluates expressions.
+//the loop body reads, compares and assigns long strings, so with std::variant values every
+//copy of a value made on the way up the tree is a heap allocation. build both value modes:
+//  g++ -std=c++17 -O2 -I../interpreter AllocBench.cpp $(ls ../interpreter/*.cpp | grep -v main.cpp) -o alloc_bench
+//  g++ -std=c++17 -O2 -DLOX_VARIANT_VALUES -I../interpreter AllocBench.cpp $(ls ../interpreter/*.cpp | grep -v main.cpp) -o alloc_bench_variant
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include "Scanner.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Interpreter.h"
+
+static size_t allocations = 0;
+
+void* operator new(size_t size)
+{
+	++allocations;
+	if (void* memory = std::malloc(size ? size : 1)) return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+static const int iterations = 1000000;
+
+//groupings, variable reads, equality tests and assignments all pass a long string up the tree
+static std::string Program()
+{
+	return "var text = \"a string that is too long for the small string buffer\";\n"
+		"var copy = \"\";\n"
+		"{\n"
+		"  var i = 0;\n"
+		"  while (i < " + std::to_string(iterations) + ") {\n"
+		"    copy = (text);\n"
+		"    if (copy == text and text != \"other\") copy = ((copy));\n"
+		"    i = i + 1;\n"
+		"  }\n"
+		"}\n"
+		"print copy;\n";
+}
+
+int main()
+{
+#ifdef LOX_VARIANT_VALUES
+	std::cout << "std::variant values\n";
+#else
+	std::cout << "NaN-boxed values\n";
+#endif
+
+	std::string source = Program();
+	Scanner scanner(source);
+	auto tokens = scanner.ScanTokens();
+	Arena arena;
+	Parser parser(tokens, arena);
+	auto statements = parser.Parse();
+	Resolver resolver;
+	if (!resolver.Resolve(statements)) return 1;
+
+	Interpreter interpreter;
+	size_t before = allocations;
+	auto start = std::chrono::steady_clock::now();
+	interpreter.Interpret(statements);
+	auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	size_t made = allocations - before;
+
+	std::cout << "treewalk: " << made << " allocations, " << double(made) / iterations << " per iteration, "
+		<< elapsed / iterations << " ns/iteration\n";
+}
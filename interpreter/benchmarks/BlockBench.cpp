@@ -0,0 +1,72 @@
+//counts heap allocations in tight loops whose body is a block, one body declaring a local
+//and one declaring nothing, through the treewalk interpreter and the closure compiler.
+//  g++ -std=c++17 -O2 -I../interpreter BlockBench.cpp $(ls ../interpreter/*.cpp | grep -v main.cpp) -o block_bench
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include "Scanner.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Interpreter.h"
+#include "ClosureCompiler.h"
+
+static size_t allocations = 0;
+
+void* operator new(size_t size)
+{
+	++allocations;
+	if (void* memory = std::malloc(size ? size : 1)) return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+static const int iterations = 1000000;
+
+static std::string Program(const std::string& body)
+{
+	return "{\n"
+		"  var i = 0;\n"
+		"  var sum = 0;\n"
+		"  while (i < " + std::to_string(iterations) + ") {\n"
+		+ body +
+		"    i = i + 1;\n"
+		"  }\n"
+		"  print sum;\n"
+		"}\n";
+}
+
+template <typename Engine>
+static void Measure(const std::string& name, const std::string& source)
+{
+	Scanner scanner(source);
+	auto tokens = scanner.ScanTokens();
+	Arena arena;
+	Parser parser(tokens, arena);
+	auto statements = parser.Parse();
+	Resolver resolver;
+	if (!resolver.Resolve(statements)) return;
+
+	Engine engine;
+	size_t before = allocations;
+	auto start = std::chrono::steady_clock::now();
+	engine.Interpret(statements);
+	auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	size_t made = allocations - before;
+	std::cout << name << ": " << made << " allocations, " << double(made) / iterations << " per iteration, "
+		<< elapsed / iterations << " ns/iteration\n";
+}
+
+int main()
+{
+	std::string declaring = Program("    var square = i * i;\n    sum = sum + square;\n");
+	std::string empty = Program("    sum = sum + i;\n");
+
+	Measure<Interpreter>("treewalk, block declares a local", declaring);
+	Measure<Interpreter>("treewalk, block declares nothing", empty);
+	Measure<ClosureCompiler>("closures, block declares a local", declaring);
+	Measure<ClosureCompiler>("closures, block declares nothing", empty);
+}
@@ -0,0 +1,82 @@
+//startup cost of a large script: scanning and parsing it cold against loading the AstCache written
+//for it, the two ways Lox::RunFile can get to a tree with --cache. the cache is written to the
+//working directory and removed again afterwards.
+//  g++ -std=c++17 -O2 -I../interpreter CacheBench.cpp $(ls ../interpreter/*.cpp | grep -v main.cpp) -o cache_bench
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "Scanner.h"
+#include "Parser.h"
+#include "AstCache.h"
+#include "Arena.h"
+
+static const char* cachePath = "cache_bench.lox.cache";
+
+static std::string Program(int blocks)
+{
+	std::ostringstream out;
+	out << "var total = 0;\n";
+	for (int i = 0; i < blocks; ++i)
+	{
+		out << "{\n"
+			<< "  var a" << i << " = " << i << ";\n"
+			<< "  var name = \"block number " << i << "\";\n"
+			<< "  var j = 0;\n"
+			<< "  while (j < 3) {\n"
+			<< "    if (a" << i << " > 10 and j != 1) total = total + a" << i << " * (j + 1) / 2;\n"
+			<< "    else { total = total - 1; }\n"
+			<< "    j = j + 1;\n"
+			<< "  }\n"
+			<< "}\n";
+	}
+	out << "print total;\n";
+	return out.str();
+}
+
+static double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+	std::string source = Program(50000);
+	std::cout << "source: " << source.size() / 1024 << " KB\n";
+
+	for (int run = 0; run < 3; ++run)
+	{
+		auto start = std::chrono::steady_clock::now();
+		Scanner scanner(source);
+		auto tokens = scanner.ScanTokens();
+		Arena parseArena;
+		Parser parser(tokens, parseArena);
+		auto parsed = parser.Parse();
+		double cold = Milliseconds(start);
+
+		start = std::chrono::steady_clock::now();
+		if (!AstCache::Write(cachePath, source, parsed))
+		{
+			std::cerr << "could not write " << cachePath << "\n";
+			return 1;
+		}
+		double write = Milliseconds(start);
+
+		//includes hashing the source, which a cached start cannot skip
+		start = std::chrono::steady_clock::now();
+		Arena cacheArena;
+		std::vector<StmtPtr> loaded;
+		bool hit = AstCache::Read(cachePath, source, cacheArena, loaded);
+		double load = Milliseconds(start);
+		if (!hit || loaded.size() != parsed.size())
+		{
+			std::cerr << "cache did not load\n";
+			return 1;
+		}
+
+		std::cout << "cold scan + parse " << cold << " ms, cache write " << write << " ms, cached load "
+			<< load << " ms (" << cold / load << "x)\n";
+	}
+	std::remove(cachePath);
+}
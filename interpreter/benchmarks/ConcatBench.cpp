@@ -0,0 +1,74 @@
+//builds a 10MB string with s = s + piece in a loop through the treewalk interpreter, the closure
+//compiler and the vm, reports the time per append. with the shared StringBuffer each append writes
+//only the piece. for comparison, s = "" + s + piece copies s into a new buffer on every step like
+//every concatenation used to, run on a 300KB string since it is quadratic.
+//  g++ -std=c++17 -O2 -I../interpreter ConcatBench.cpp $(ls ../interpreter/*.cpp | grep -v main.cpp) -o concat_bench
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "Scanner.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Interpreter.h"
+#include "ClosureCompiler.h"
+#include "Compiler.h"
+#include "VM.h"
+
+//ten characters per append
+static std::string Program(int appends, const std::string& append)
+{
+	return "var s = \"\";\n"
+		"{\n"
+		"  var i = 0;\n"
+		"  while (i < " + std::to_string(appends) + ") {\n"
+		"    s = " + append + ";\n"
+		"    i = i + 1;\n"
+		"  }\n"
+		"}\n"
+		"print s == \"\";\n";
+}
+
+template <typename Run>
+static void Measure(const std::string& name, int appends, Run run)
+{
+	auto start = std::chrono::steady_clock::now();
+	run();
+	auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	std::cout << name << ": " << elapsed / 1e6 << " ms, " << elapsed / appends << " ns/append\n";
+}
+
+static void RunAll(const std::string& title, int appends, const std::string& append)
+{
+	std::cout << title << ", " << appends * 10 / 1000000.0 << " MB\n";
+	std::string source = Program(appends, append);
+	Scanner scanner(source);
+	auto tokens = scanner.ScanTokens();
+	Arena arena;
+	Parser parser(tokens, arena);
+	auto statements = parser.Parse();
+	Resolver resolver;
+	if (!resolver.Resolve(statements)) return;
+
+	Measure("treewalk", appends, [&]() {
+		Interpreter interpreter;
+		interpreter.Interpret(statements);
+	});
+
+	Measure("closures", appends, [&]() {
+		ClosureCompiler closures;
+		closures.Interpret(statements);
+	});
+
+	Compiler compiler;
+	Chunk chunk = compiler.Compile(statements);
+	Measure("vm", appends, [&]() {
+		VM vm;
+		vm.Interpret(chunk);
+	});
+}
+
+int main()
+{
+	RunAll("s = s + piece", 1000000, "s + \"0123456789\"");
+	RunAll("s = \"\" + s + piece, copies s", 30000, "\"\" + s + \"0123456789\"");
+}
@@ -0,0 +1,58 @@
+//counting loop through the treewalk interpreter with and without the Fuser, reports iterations per second.
+//  g++ -std=c++17 -O2 -I../interpreter LoopBench.cpp $(ls ../interpreter/*.cpp | grep -v main.cpp) -o loop_bench
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "Scanner.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Fuser.h"
+#include "Interpreter.h"
+
+static const int iterations = 10000000;
+
+static std::string Program()
+{
+	return "{\n"
+		"  var i = 0;\n"
+		"  var n = " + std::to_string(iterations) + ";\n"
+		"  var sum = 0;\n"
+		"  while (i < n) {\n"
+		"    sum = sum + i;\n"
+		"    i = i + 1;\n"
+		"  }\n"
+		"  print sum;\n"
+		"}\n";
+}
+
+static void Measure(const std::string& source, bool fuse)
+{
+	Scanner scanner(source);
+	auto tokens = scanner.ScanTokens();
+	Arena arena;
+	Parser parser(tokens, arena);
+	auto statements = parser.Parse();
+	Resolver resolver;
+	if (!resolver.Resolve(statements)) return;
+	if (fuse)
+	{
+		Fuser fuser(arena);
+		fuser.Fuse(statements);
+	}
+
+	Interpreter interpreter;
+	auto start = std::chrono::steady_clock::now();
+	interpreter.Interpret(statements);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << (fuse ? "fused:   " : "unfused: ") << iterations / seconds / 1e6 << " M iterations/s\n";
+}
+
+int main()
+{
+	std::string source = Program();
+	for (int round = 0; round < 3; ++round)
+	{
+		Measure(source, false);
+		Measure(source, true);
+	}
+}
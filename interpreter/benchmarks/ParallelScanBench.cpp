@@ -0,0 +1,89 @@
+//scaling of the ParallelScanner over 1, 2, 4 and 8 threads on a generated source of 100MB by
+//default (the first argument sets the size in MB), against the plain Scanner. the source has
+//strings running over several lines and comments with quotes in them, so chunk starts land in
+//both. every run is checked against the tokens of the plain Scanner.
+//  g++ -std=c++17 -O2 -pthread -I../interpreter ParallelScanBench.cpp $(ls ../interpreter/*.cpp | grep -v main.cpp) -o parallel_scan_bench
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "Scanner.h"
+#include "ParallelScanner.h"
+#include "ThreadPool.h"
+
+static std::string Program(size_t bytes)
+{
+	std::ostringstream out;
+	out << "var total = 0;\n";
+	for (int i = 0; out.tellp() < static_cast<std::streamoff>(bytes); ++i)
+	{
+		out << "{\n"
+			<< "  var a" << i % 1000 << " = " << i << ";\n"
+			<< "  var name = \"block // number\n  " << i << " spans a line\";\n"
+			<< "  // a \"quote\" in a comment\n"
+			<< "  while (a" << i % 1000 << " < 3) {\n"
+			<< "    if (a" << i % 1000 << " > 10 and name != \"x\") total = total + a" << i % 1000 << " * (2 + 1) / 2;\n"
+			<< "    else { total = total - 1; }\n"
+			<< "  }\n"
+			<< "}\n";
+	}
+	out << "print total;\n";
+	return out.str();
+}
+
+static bool SameTokens(const std::vector<Token>& expected, const std::vector<Token>& actual)
+{
+	if (expected.size() != actual.size()) return false;
+	for (size_t i = 0; i < expected.size(); ++i)
+	{
+		const Token& a = expected[i];
+		const Token& b = actual[i];
+		//both views into the source, apart from the empty one of END_OF_FILE
+		if (a.type != b.type || a.line != b.line || a.lexeme.size() != b.lexeme.size()) return false;
+		if (!a.lexeme.empty() && a.lexeme.data() != b.lexeme.data()) return false;
+		if (IsString(a.lit) != IsString(b.lit) || (IsString(a.lit) && AsString(a.lit) != AsString(b.lit))) return false;
+		if (IsNumber(a.lit) && AsNumber(a.lit) != AsNumber(b.lit)) return false;
+	}
+	return true;
+}
+
+template <typename Scan>
+static double BestMs(Scan scan)
+{
+	double best = 1e300;
+	for (int run = 0; run < 3; ++run)
+	{
+		auto start = std::chrono::steady_clock::now();
+		scan();
+		best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+	return best;
+}
+
+int main(int argc, char* argv[])
+{
+	size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100;
+	std::string source = Program(megabytes << 20);
+	std::vector<Token> expected = Scanner(source).ScanTokens();
+	std::cout << "source: " << source.size() / (1 << 20) << " MB, " << expected.size() << " tokens, "
+		<< std::thread::hardware_concurrency() << " cores\n";
+
+	double serial = BestMs([&]() { Scanner(source).ScanTokens(); });
+	std::cout << "Scanner:            " << serial << " ms, " << expected.size() / serial / 1e3 << " M tokens/s\n";
+
+	for (unsigned threads : { 1u, 2u, 4u, 8u })
+	{
+		ThreadPool pool(threads);
+		if (!SameTokens(expected, ParallelScanner(source, pool).ScanTokens()))
+		{
+			std::cout << threads << " threads: tokens differ from the Scanner\n";
+			return 1;
+		}
+		double ms = BestMs([&]() { ParallelScanner(source, pool).ScanTokens(); });
+		std::cout << "ParallelScanner x" << threads << ": " << ms << " ms, " << expected.size() / ms / 1e3
+			<< " M tokens/s, " << serial / ms << "x\n";
+	}
+}
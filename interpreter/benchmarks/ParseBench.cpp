@@ -0,0 +1,120 @@
+//parse and treewalk timing on a large synthetic script, plus the cache misses of the
+//interpreter run read from the hardware counters (linux perf_event_open, reported as -1
+//when the counters are not available, e.g. in containers).
+//  g++ -std=c++17 -O2 -I../interpreter ParseBench.cpp $(ls ../interpreter/*.cpp | grep -v main.cpp) -o parse_bench
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <sstream>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include "Scanner.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Interpreter.h"
+#include "Arena.h"
+
+//counts last level cache misses of this thread between Start and Stop
+class CacheMissCounter
+{
+public:
+	CacheMissCounter()
+	{
+#ifdef __linux__
+		perf_event_attr attr{};
+		attr.size = sizeof attr;
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = PERF_COUNT_HW_CACHE_MISSES;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+	}
+	~CacheMissCounter()
+	{
+#ifdef __linux__
+		if (fd >= 0) close(fd);
+#endif
+	}
+	void Start()
+	{
+#ifdef __linux__
+		if (fd < 0) return;
+		ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+	}
+	//-1 when hardware counters are not available
+	long long Stop()
+	{
+#ifdef __linux__
+		if (fd < 0) return -1;
+		ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		long long count = 0;
+		if (read(fd, &count, sizeof count) != sizeof count) return -1;
+		return count;
+#else
+		return -1;
+#endif
+	}
+private:
+	int fd = -1;
+};
+
+static std::string Program(int blocks)
+{
+	std::ostringstream out;
+	out << "var total = 0;\n";
+	for (int i = 0; i < blocks; ++i)
+	{
+		out << "{\n"
+			<< "  var a" << i << " = " << i << ";\n"
+			<< "  var name = \"block number " << i << "\";\n"
+			<< "  var j = 0;\n"
+			<< "  while (j < 3) {\n"
+			<< "    if (a" << i << " > 10 and j != 1) total = total + a" << i << " * (j + 1) / 2;\n"
+			<< "    else { total = total - 1; }\n"
+			<< "    j = j + 1;\n"
+			<< "  }\n"
+			<< "}\n";
+	}
+	out << "print total;\n";
+	return out.str();
+}
+
+int main()
+{
+	std::string source = Program(50000);
+	std::cout << "source: " << source.size() / 1024 << " KB\n";
+	Scanner scanner(source);
+	auto tokens = scanner.ScanTokens();
+	std::cout << "tokens: " << tokens.size() << "\n";
+
+	CacheMissCounter misses;
+	for (int run = 0; run < 3; ++run)
+	{
+		auto start = std::chrono::steady_clock::now();
+		Arena arena;
+		Parser parser(tokens, arena);
+		auto statements = parser.Parse();
+		auto parsed = std::chrono::steady_clock::now();
+
+		Resolver resolver;
+		resolver.Resolve(statements);
+		Interpreter interpreter;
+		misses.Start();
+		auto runStart = std::chrono::steady_clock::now();
+		interpreter.Interpret(statements);
+		auto runEnd = std::chrono::steady_clock::now();
+		long long count = misses.Stop();
+
+		std::cout << "parse " << std::chrono::duration<double, std::milli>(parsed - start).count() << " ms ("
+			<< arena.BytesUsed() / 1024 << " KB arena), run "
+			<< std::chrono::duration<double, std::milli>(runEnd - runStart).count() << " ms, cache misses " << count << "\n";
+	}
+}
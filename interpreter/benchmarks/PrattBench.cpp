@@ -0,0 +1,312 @@
+//parse throughput in tokens per second of the Pratt expression parser in Parser against the
+//recursive descent parser it replaced, kept below as RecursiveDescentParser. that one copies a
+//Token out of every Peek, Previous and Advance, matches an initializer_list of types per rule and
+//goes down all eight precedence levels for every operand. both build the same tree in the same
+//kind of arena, from the same tokens.
+//  g++ -std=c++17 -O2 -I../interpreter PrattBench.cpp $(ls ../interpreter/*.cpp | grep -v main.cpp) -o pratt_bench
+#include <algorithm>
+#include <chrono>
+#include <initializer_list>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "Scanner.h"
+#include "Parser.h"
+#include "Arena.h"
+
+//the parser before the Pratt rewrite, without its error reporting. the benchmark source has no
+//errors
+class RecursiveDescentParser
+{
+public:
+	RecursiveDescentParser(const std::vector<Token>& tokens, Arena& arena) : tokens(tokens), arena(arena) {}
+
+	std::vector<StmtPtr> Parse()
+	{
+		std::vector<StmtPtr> statements;
+		while (current < tokens.size() && tokens[current].type != TokenType::END_OF_FILE) {
+			statements.push_back(Declaration());
+		}
+		return statements;
+	}
+
+private:
+	const std::vector<Token>& tokens;
+	Arena& arena;
+	size_t current = 0;
+
+	StmtPtr Declaration()
+	{
+		if (Match({ TokenType::VAR })) return VarDeclaration();
+		return Statement();
+	}
+
+	StmtPtr Statement()
+	{
+		if (Match({ TokenType::IF })) return IfStatement();
+		if (Match({ TokenType::WHILE })) return WhileStatement();
+		if (Match({ TokenType::PRINT })) return PrintStatement();
+		if (Match({ TokenType::LEFT_BRACE })) return BlockStatement();
+		return ExpressionStatement();
+	}
+
+	StmtPtr PrintStatement()
+	{
+		auto expr = Expression();
+		Consume(TokenType::SEMICOLON);
+		return arena.Make<PrintStmt>(std::move(expr));
+	}
+
+	StmtPtr ExpressionStatement()
+	{
+		auto expr = Expression();
+		Consume(TokenType::SEMICOLON);
+		return arena.Make<ExpressionStmt>(std::move(expr));
+	}
+
+	StmtPtr VarDeclaration()
+	{
+		Token name = Keep(Consume(TokenType::IDENTIFIER));
+		ExprPtr initializer = nullptr;
+		if (Match({ TokenType::EQUAL })) {
+			initializer = Expression();
+		}
+		Consume(TokenType::SEMICOLON);
+		return arena.Make<VarStmt>(name, std::move(initializer));
+	}
+
+	StmtPtr BlockStatement()
+	{
+		std::vector<StmtPtr> statements;
+		while (!Check(TokenType::RIGHT_BRACE) && !IsAtEnd()) {
+			statements.push_back(Declaration());
+		}
+		Consume(TokenType::RIGHT_BRACE);
+		return arena.Make<BlockStmt>(std::move(statements));
+	}
+
+	StmtPtr IfStatement()
+	{
+		Consume(TokenType::LEFT_PAREN);
+		auto condition = Expression();
+		Consume(TokenType::RIGHT_PAREN);
+		auto thenBranch = Statement();
+		StmtPtr elseBranch = nullptr;
+		if (Match({ TokenType::ELSE })) {
+			elseBranch = Statement();
+		}
+		return arena.Make<IfStmt>(std::move(condition), std::move(thenBranch), std::move(elseBranch));
+	}
+
+	StmtPtr WhileStatement()
+	{
+		Consume(TokenType::LEFT_PAREN);
+		auto condition = Expression();
+		Consume(TokenType::RIGHT_PAREN);
+		auto body = Statement();
+		return arena.Make<WhileStmt>(std::move(condition), std::move(body));
+	}
+
+	ExprPtr Expression() { return Assignment(); }
+
+	ExprPtr Assignment()
+	{
+		auto expr = Logical();
+		if (Match({ TokenType::EQUAL })) {
+			auto value = Assignment();
+			if (auto varExpr = dynamic_cast<VariableExpr*>(expr.get())) {
+				Token name = varExpr->name;
+				return arena.Make<AssignExpr>(name, std::move(value));
+			}
+		}
+		return expr;
+	}
+
+	ExprPtr Logical()
+	{
+		auto expr = Equality();
+		while (Match({ TokenType::AND, TokenType::OR })) {
+			Token op = Keep(Previous());
+			auto right = Equality();
+			expr = arena.Make<LogicalExpr>(std::move(expr), op, std::move(right));
+		}
+		return expr;
+	}
+
+	ExprPtr Equality()
+	{
+		auto expr = Comparison();
+		while (Match({ TokenType::BANG_EQUAL, TokenType::EQUAL_EQUAL })) {
+			Token op = Keep(Previous());
+			auto right = Comparison();
+			expr = arena.Make<BinaryExpr>(std::move(expr), op, std::move(right));
+		}
+		return expr;
+	}
+
+	ExprPtr Comparison()
+	{
+		auto expr = Term();
+		while (Match({ TokenType::GREATER, TokenType::GREATER_EQUAL, TokenType::LESS, TokenType::LESS_EQUAL })) {
+			Token op = Keep(Previous());
+			auto right = Term();
+			expr = arena.Make<BinaryExpr>(std::move(expr), op, std::move(right));
+		}
+		return expr;
+	}
+
+	ExprPtr Term()
+	{
+		auto expr = Factor();
+		while (Match({ TokenType::MINUS, TokenType::PLUS })) {
+			Token op = Keep(Previous());
+			auto right = Factor();
+			expr = arena.Make<BinaryExpr>(std::move(expr), op, std::move(right));
+		}
+		return expr;
+	}
+
+	ExprPtr Factor()
+	{
+		auto expr = Unary();
+		while (Match({ TokenType::SLASH, TokenType::STAR })) {
+			Token op = Keep(Previous());
+			auto right = Unary();
+			expr = arena.Make<BinaryExpr>(std::move(expr), op, std::move(right));
+		}
+		return expr;
+	}
+
+	ExprPtr Unary()
+	{
+		if (Match({ TokenType::BANG, TokenType::MINUS })) {
+			Token op = Keep(Previous());
+			auto right = Unary();
+			return arena.Make<UnaryExpr>(op, std::move(right));
+		}
+		return Primary();
+	}
+
+	ExprPtr Primary()
+	{
+		if (Match({ TokenType::FALSE })) return arena.Make<LiteralExpr>(false);
+		if (Match({ TokenType::TRUE })) return arena.Make<LiteralExpr>(true);
+		if (Match({ TokenType::NIL })) return arena.Make<LiteralExpr>(LoxValue());
+		if (Match({ TokenType::NUMBER, TokenType::STRING })) {
+			return arena.Make<LiteralExpr>(Previous().lit);
+		}
+		if (Match({ TokenType::IDENTIFIER })) {
+			return arena.Make<VariableExpr>(Keep(Previous()));
+		}
+		Consume(TokenType::LEFT_PAREN);
+		auto expr = Expression();
+		Consume(TokenType::RIGHT_PAREN);
+		return arena.Make<GroupingExpr>(std::move(expr));
+	}
+
+	bool Match(std::initializer_list<TokenType> types)
+	{
+		for (TokenType type : types) {
+			if (Check(type)) {
+				Advance();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool Check(TokenType type) const
+	{
+		if (IsAtEnd()) return false;
+		return Peek().type == type;
+	}
+
+	const Token Advance()
+	{
+		if (!IsAtEnd()) current++;
+		Token a = Previous();
+		return a;
+	}
+
+	bool IsAtEnd() const { return Peek().type == TokenType::END_OF_FILE; }
+
+	const Token Peek() const
+	{
+		Token a = tokens[current];
+		return a;
+	}
+
+	const Token Previous() const { return tokens[current - 1]; }
+
+	const Token Consume(TokenType type)
+	{
+		if (!Check(type)) throw ParseError("unexpected token");
+		return Advance();
+	}
+
+	Token Keep(const Token& token)
+	{
+		Token kept = token;
+		kept.lexeme = arena.CopyString(token.lexeme);
+		return kept;
+	}
+};
+
+//mostly expressions, with operators from every precedence level
+static std::string Program(int blocks)
+{
+	std::ostringstream out;
+	out << "var total = 0;\n";
+	for (int i = 0; i < blocks; ++i)
+	{
+		out << "{\n"
+			<< "  var a" << i << " = " << i << " * 2 + 1;\n"
+			<< "  var name = \"block number " << i << "\";\n"
+			<< "  var j = -(a" << i << " - 3) / 4;\n"
+			<< "  while (j < 3 and !(j == a" << i << ")) {\n"
+			<< "    if (a" << i << " > 10 and j != 1 or false) total = total + a" << i << " * (j + 1) / 2 - 7;\n"
+			<< "    else { total = total - 1 >= 0 == true; }\n"
+			<< "    j = j + 1;\n"
+			<< "  }\n"
+			<< "}\n";
+	}
+	out << "print total;\n";
+	return out.str();
+}
+
+//best of a few runs, in tokens per second
+template <typename Parse>
+static double Throughput(size_t tokens, Parse parse)
+{
+	double best = 0;
+	for (int run = 0; run < 5; ++run)
+	{
+		auto start = std::chrono::steady_clock::now();
+		parse();
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		best = std::max(best, tokens / seconds);
+	}
+	return best;
+}
+
+int main()
+{
+	std::string source = Program(50000);
+	Scanner scanner(source);
+	auto tokens = scanner.ScanTokens();
+	std::cout << "source: " << source.size() / 1024 << " KB, " << tokens.size() << " tokens\n";
+
+	double recursive = Throughput(tokens.size(), [&]() {
+		Arena arena;
+		RecursiveDescentParser parser(tokens, arena);
+		auto statements = parser.Parse();
+	});
+	double pratt = Throughput(tokens.size(), [&]() {
+		Arena arena;
+		Parser parser(tokens, arena);
+		auto statements = parser.Parse();
+	});
+
+	std::cout << "recursive descent: " << recursive / 1e6 << " M tokens/s\n";
+	std::cout << "pratt:             " << pratt / 1e6 << " M tokens/s (" << pratt / recursive << "x)\n";
+}
@@ -0,0 +1,102 @@
+//scanner throughput on a generated multi-megabyte script read through a MappedFile, plus a
+//comparison of the switch based keyword recogniser with the hash map lookup it replaced.
+//  g++ -std=c++17 -O2 -I../interpreter ScanBench.cpp $(ls ../interpreter/*.cpp | grep -v main.cpp) -o scan_bench
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include "Scanner.h"
+#include "MappedFile.h"
+
+static std::string Program(int blocks)
+{
+	std::ostringstream out;
+	out << "var total = 0;\n";
+	for (int i = 0; i < blocks; ++i)
+	{
+		out << "// block " << i << " adds up a few numbers\n"
+			<< "{\n"
+			<< "  var value" << i << " = " << i << ".5;\n"
+			<< "  var label = \"block number " << i << "\";\n"
+			<< "  while (value" << i << " > 0 and total != nil) {\n"
+			<< "    if (value" << i << " >= 10) print label; else total = total + value" << i << " * 2;\n"
+			<< "    value" << i << " = value" << i << " - 100;\n"
+			<< "  }\n"
+			<< "}\n";
+	}
+	return out.str();
+}
+
+static double Seconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+	const std::string path = "scan_bench_input.lox";
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << Program(100000);
+	}
+
+	MappedFile file(path);
+	std::string_view source = file.Contents();
+	double megabytes = source.size() / (1024.0 * 1024.0);
+	std::cout << "source: " << megabytes << " MB\n";
+
+	std::vector<Token> tokens;
+	double best = 1e9;
+	for (int run = 0; run < 5; ++run)
+	{
+		auto start = std::chrono::steady_clock::now();
+		Scanner scanner(source);
+		tokens = scanner.ScanTokens();
+		best = std::min(best, Seconds(start));
+	}
+	std::cout << "scan: " << tokens.size() << " tokens, " << megabytes / best << " MB/s\n";
+
+	//keyword recognition alone, over every identifier and keyword lexeme of the script
+	std::vector<std::string_view> words;
+	for (const auto& token : tokens)
+	{
+		if (token.type == TokenType::IDENTIFIER || Scanner::KeywordType(token.lexeme) != TokenType::IDENTIFIER)
+		{
+			words.push_back(token.lexeme);
+		}
+	}
+	static const std::unordered_map<std::string_view, TokenType> keywords = {
+		{"and", TokenType::AND}, {"class", TokenType::CLASS}, {"else", TokenType::ELSE},
+		{"false", TokenType::FALSE}, {"for", TokenType::FOR}, {"fun", TokenType::FUN},
+		{"if", TokenType::IF}, {"nil", TokenType::NIL}, {"or", TokenType::OR},
+		{"print", TokenType::PRINT}, {"return", TokenType::RETURN}, {"super", TokenType::SUPER},
+		{"this", TokenType::THIS}, {"true", TokenType::TRUE}, {"var", TokenType::VAR},
+		{"while", TokenType::WHILE}
+	};
+
+	size_t found = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (auto word : words)
+	{
+		auto iter = keywords.find(word);
+		found += iter != keywords.end();
+	}
+	double mapTime = Seconds(start);
+
+	size_t switched = 0;
+	start = std::chrono::steady_clock::now();
+	for (auto word : words)
+	{
+		switched += Scanner::KeywordType(word) != TokenType::IDENTIFIER;
+	}
+	double switchTime = Seconds(start);
+
+	std::cout << "keywords: " << words.size() << " words, hash map " << mapTime * 1e9 / words.size()
+		<< " ns/word, switch " << switchTime * 1e9 / words.size() << " ns/word ("
+		<< found << "/" << switched << " keywords)\n";
+
+	std::remove(path.c_str());
+}
@@ -0,0 +1,109 @@
+//compares the scalar, SSE2 and AVX2 scan kernels on a script with large comment banners,
+//deep indentation and long string payloads. reports bytes per cycle of each kernel on its own
+//(walking the whole source line by line, and through a long whitespace run) and of the whole
+//scanner, and checks that all kernels produce the same tokens and line numbers.
+//  g++ -std=c++17 -O2 -I../interpreter SkipBench.cpp $(ls ../interpreter/*.cpp | grep -v main.cpp) -o skip_bench
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Scanner.h"
+#include "ScanKernels.h"
+#if defined(_M_X64) || defined(__x86_64__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define HAVE_RDTSC 1
+#endif
+
+static std::string Program(int sections)
+{
+	std::ostringstream out;
+	std::string banner(100, '=');
+	std::string payload;
+	for (int i = 0; i < 20; ++i) payload += "lorem ipsum dolor sit amet ";
+	for (int i = 0; i < sections; ++i)
+	{
+		out << "//" << banner << "\n"
+			<< "// section " << i << ": generated report block, do not edit by hand\n"
+			<< "//" << banner << "\n\n\n"
+			<< "{\n"
+			<< "                var text = \"" << payload << i << "\";\n"
+			<< "                var multi = \"first line\n" << payload << "\nthird line\";\n"
+			<< "                        print text;\n"
+			<< "}\n\n";
+	}
+	return out.str();
+}
+
+//cpu cycles (time stamp counter) on x86-64, steady_clock ticks elsewhere
+static unsigned long long Ticks()
+{
+#ifdef HAVE_RDTSC
+	return __rdtsc();
+#else
+	return static_cast<unsigned long long>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+int main()
+{
+	std::string source = Program(40000);
+	std::cout << "source: " << source.size() / (1024 * 1024) << " MB\n";
+
+	std::vector<const ScanKernels*> kernels = { &ScanKernels::Scalar(), ScanKernels::Sse2(), ScanKernels::Avx2() };
+	size_t expectedTokens = 0;
+	int expectedLine = 0;
+	std::string blank(1 << 20, ' ');
+	for (size_t i = 100; i < blank.size(); i += 200) blank[i] = '\n';
+	blank.back() = 'x';
+
+	for (const ScanKernels* kernel : kernels)
+	{
+		if (kernel == nullptr) continue;
+
+		//the kernels alone
+		const char* end = source.data() + source.size();
+		unsigned long long start = Ticks();
+		size_t lines = 0;
+		for (const char* position = source.data(); position < end; position++)
+		{
+			position = kernel->findLineEnd(position, end);
+			lines++;
+		}
+		unsigned long long lineTicks = Ticks() - start;
+
+		int blankLines = 0;
+		start = Ticks();
+		for (int run = 0; run < 50; ++run)
+		{
+			kernel->skipWhitespace(blank.data(), blank.data() + blank.size(), blankLines);
+		}
+		unsigned long long blankTicks = Ticks() - start;
+		std::cout << kernel->name << " kernels: line ends " << static_cast<double>(source.size()) / lineTicks
+			<< " bytes/tick (" << lines << " lines), whitespace " << 50.0 * blank.size() / blankTicks << " bytes/tick\n";
+
+		unsigned long long best = ~0ull;
+		std::vector<Token> tokens;
+		for (int run = 0; run < 5; ++run)
+		{
+			unsigned long long start = Ticks();
+			Scanner scanner(source, *kernel);
+			tokens = scanner.ScanTokens();
+			best = std::min(best, Ticks() - start);
+		}
+
+		if (expectedTokens == 0)
+		{
+			expectedTokens = tokens.size();
+			expectedLine = tokens.back().line;
+		}
+		bool same = tokens.size() == expectedTokens && tokens.back().line == expectedLine;
+		std::cout << kernel->name << " scanner: " << static_cast<double>(source.size()) / best << " bytes/tick";
+		std::cout << ", " << tokens.size() << " tokens, last line " << tokens.back().line
+			<< (same ? "" : "  MISMATCH") << (kernel == &ScanKernels::Active() ? "  (active)" : "") << "\n";
+	}
+}
@@ -0,0 +1,75 @@
+//microbenchmark for the value representation: runs an arithmetic loop through the
+//treewalk interpreter, the closure compiler and the vm and reports the time per loop iteration.
+//build it twice to compare the NaN-boxed values with the old std::variant:
+//  g++ -std=c++17 -O2 -I../interpreter ValueBench.cpp $(ls ../interpreter/*.cpp | grep -v main.cpp) -o value_bench
+//  g++ -std=c++17 -O2 -DLOX_VARIANT_VALUES -I../interpreter ValueBench.cpp $(ls ../interpreter/*.cpp | grep -v main.cpp) -o value_bench_variant
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "Scanner.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Interpreter.h"
+#include "ClosureCompiler.h"
+#include "Compiler.h"
+#include "VM.h"
+
+static const int iterations = 5000000;
+
+static std::string Program()
+{
+	return "var sum = 0;\n"
+		"{\n"
+		"  var i = 0;\n"
+		"  while (i < " + std::to_string(iterations) + ") {\n"
+		"    sum = sum + i * 2 - i / 4;\n"
+		"    i = i + 1;\n"
+		"  }\n"
+		"}\n"
+		"print sum;\n";
+}
+
+template <typename Run>
+static void Measure(const std::string& name, Run run)
+{
+	auto start = std::chrono::steady_clock::now();
+	run();
+	auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	std::cout << name << ": " << elapsed / 1e6 << " ms, " << elapsed / iterations << " ns/iteration\n";
+}
+
+int main()
+{
+#ifdef LOX_VARIANT_VALUES
+	std::cout << "std::variant values";
+#else
+	std::cout << "NaN-boxed values";
+#endif
+	std::cout << ", sizeof(LoxValue) = " << sizeof(LoxValue) << "\n";
+
+	std::string source = Program();
+	Scanner scanner(source);
+	auto tokens = scanner.ScanTokens();
+	Arena arena;
+	Parser parser(tokens, arena);
+	auto statements = parser.Parse();
+	Resolver resolver;
+	if (!resolver.Resolve(statements)) return 1;
+
+	Measure("treewalk", [&]() {
+		Interpreter interpreter;
+		interpreter.Interpret(statements);
+	});
+
+	Measure("closures", [&]() {
+		ClosureCompiler closures;
+		closures.Interpret(statements);
+	});
+
+	Compiler compiler;
+	Chunk chunk = compiler.Compile(statements);
+	Measure("vm", [&]() {
+		VM vm;
+		vm.Interpret(chunk);
+	});
+}
@@ -0,0 +1,393 @@
+//runs the Lox programs in benchmarks/suite, plus a generated large file that is only scanned and
+//parsed, through the Scanner, Parser and treewalk Interpreter the same way Lox::Run does.
+//for each one it reports wall time per phase, ns per loop iteration (the "//iterations: n" line
+//at the top of the program), heap allocations and peak RSS as JSON. a results file saved with
+//--out can be passed back with --baseline, every benchmark that got slower or allocates more
+//than --threshold percent is reported and the harness exits with 1.
+//build with the CMakeLists.txt next to interpreter.sln, or by hand:
+//  g++ -std=c++17 -O2 -I../../interpreter BenchHarness.cpp $(ls ../../interpreter/*.cpp | grep -v main.cpp) -o lox_bench
+//  ./lox_bench --suite ../suite --out baseline.json
+//  ./lox_bench --suite ../suite --baseline baseline.json
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+#include "Scanner.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Optimizer.h"
+#include "Fuser.h"
+#include "Interpreter.h"
+#include "OutputSink.h"
+#include "Lox.h"
+
+#ifndef LOX_BENCH_SUITE
+#define LOX_BENCH_SUITE "suite"
+#endif
+
+static size_t allocations = 0;
+static size_t allocatedBytes = 0;
+
+void* operator new(size_t size)
+{
+	++allocations;
+	allocatedBytes += size;
+	if (void* memory = std::malloc(size ? size : 1)) return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+//print output of the programs is formatted as usual and then thrown away
+class DiscardBuffer : public std::streambuf
+{
+protected:
+	int overflow(int c) override { return c; }
+	std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+//peak resident set size of the process in KB, -1 when it cannot be read
+class PeakRss
+{
+public:
+	//starts a new peak from the current size, where the kernel allows it
+	static void Reset()
+	{
+#ifdef __linux__
+		std::ofstream clear("/proc/self/clear_refs");
+		clear << "5";
+#endif
+	}
+
+	static long Read()
+	{
+#ifdef __linux__
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line))
+		{
+			if (line.rfind("VmHWM:", 0) == 0) return std::atol(line.c_str() + 6);
+		}
+		//no procfs, the peak of the whole run is the best there is
+		rusage usage{};
+		if (getrusage(RUSAGE_SELF, &usage) == 0) return usage.ru_maxrss;
+#endif
+		return -1;
+	}
+};
+
+struct Benchmark
+{
+	std::string name;
+	std::string source;
+	long long iterations = 1;
+	bool execute = true;
+};
+
+struct Result
+{
+	std::string name;
+	long long iterations = 0;
+	double wallMs = 0;
+	double scanMs = 0;
+	double parseMs = 0;
+	double executeMs = 0;
+	size_t allocations = 0;
+	size_t allocatedBytes = 0;
+	long peakRssKb = -1;
+	bool failed = false;
+
+	double NsPerIteration() const { return wallMs * 1e6 / iterations; }
+};
+
+static double Milliseconds(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+	return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+static Result Run(const Benchmark& benchmark)
+{
+	DiscardBuffer discard;
+	std::ostream discardStream(&discard);
+	Result result;
+	result.name = benchmark.name;
+	result.iterations = benchmark.iterations;
+	Lox::hadError = false;
+	Lox::hadRuntimeError = false;
+
+	PeakRss::Reset();
+	size_t allocationsBefore = allocations;
+	size_t bytesBefore = allocatedBytes;
+	auto start = std::chrono::steady_clock::now();
+	{
+		Scanner scanner(benchmark.source);
+		auto tokens = scanner.ScanTokens();
+		auto scanned = std::chrono::steady_clock::now();
+
+		Arena arena;
+		Parser parser(tokens, arena);
+		auto statements = parser.Parse();
+		if (parser.HadError()) Lox::hadError = true;
+		auto parsed = std::chrono::steady_clock::now();
+		result.scanMs = Milliseconds(start, scanned);
+		result.parseMs = Milliseconds(scanned, parsed);
+
+		if (benchmark.execute && !Lox::hadError)
+		{
+			Resolver resolver;
+			if (resolver.Resolve(statements))
+			{
+				Optimizer(arena).Optimize(statements);
+				Fuser(arena).Fuse(statements);
+				OutputSink output(discardStream);
+				Interpreter interpreter(output);
+				interpreter.Interpret(statements);
+			}
+			else result.failed = true;
+			result.executeMs = Milliseconds(parsed, std::chrono::steady_clock::now());
+		}
+	}
+	result.wallMs = Milliseconds(start, std::chrono::steady_clock::now());
+	result.allocations = allocations - allocationsBefore;
+	result.allocatedBytes = allocatedBytes - bytesBefore;
+	result.peakRssKb = PeakRss::Read();
+	result.failed = result.failed || Lox::hadError || Lox::hadRuntimeError;
+	return result;
+}
+
+static long long IterationsOf(const std::string& source)
+{
+	const std::string marker = "//iterations:";
+	if (source.rfind(marker, 0) != 0) return 1;
+	long long iterations = std::atoll(source.c_str() + marker.size());
+	return iterations > 0 ? iterations : 1;
+}
+
+static std::vector<Benchmark> LoadSuite(const std::string& directory)
+{
+	std::vector<Benchmark> suite;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+	{
+		if (entry.path().extension() != ".lox") continue;
+		std::ifstream file(entry.path(), std::ios::binary);
+		std::stringstream contents;
+		contents << file.rdbuf();
+		Benchmark benchmark;
+		benchmark.name = entry.path().stem().string();
+		benchmark.source = contents.str();
+		benchmark.iterations = IterationsOf(benchmark.source);
+		suite.push_back(std::move(benchmark));
+	}
+	std::sort(suite.begin(), suite.end(), [](const Benchmark& a, const Benchmark& b) { return a.name < b.name; });
+	return suite;
+}
+
+//a script of many small blocks, too large to keep in the repository. only scanned and parsed
+static Benchmark LargeParse(int blocks)
+{
+	std::ostringstream out;
+	out << "var total = 0;\n";
+	for (int i = 0; i < blocks; ++i)
+	{
+		out << "{\n"
+			<< "  var a" << i << " = " << i << ";\n"
+			<< "  var name = \"block number " << i << "\";\n"
+			<< "  var j = 0;\n"
+			<< "  while (j < 3) {\n"
+			<< "    if (a" << i << " > 10 and j != 1) total = total + a" << i << " * (j + 1) / 2;\n"
+			<< "    else { total = total - 1; }\n"
+			<< "    j = j + 1;\n"
+			<< "  }\n"
+			<< "}\n";
+	}
+	Benchmark benchmark;
+	benchmark.name = "large_parse";
+	benchmark.source = out.str();
+	benchmark.iterations = blocks;
+	benchmark.execute = false;
+	return benchmark;
+}
+
+static void WriteJson(std::ostream& out, const std::vector<Result>& results, int repeat)
+{
+	out << std::setprecision(6) << std::fixed;
+	out << "{\n";
+#ifdef LOX_VARIANT_VALUES
+	out << "  \"values\": \"variant\",\n";
+#else
+	out << "  \"values\": \"nan-boxed\",\n";
+#endif
+	out << "  \"repeat\": " << repeat << ",\n";
+	out << "  \"benchmarks\": [\n";
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const Result& result = results[i];
+		out << "    {\"name\": \"" << result.name << "\""
+			<< ", \"iterations\": " << result.iterations
+			<< ", \"wall_ms\": " << result.wallMs
+			<< ", \"scan_ms\": " << result.scanMs
+			<< ", \"parse_ms\": " << result.parseMs
+			<< ", \"execute_ms\": " << result.executeMs
+			<< ", \"ns_per_iteration\": " << result.NsPerIteration()
+			<< ", \"allocations\": " << result.allocations
+			<< ", \"allocated_bytes\": " << result.allocatedBytes
+			<< ", \"peak_rss_kb\": " << result.peakRssKb
+			<< ", \"failed\": " << (result.failed ? "true" : "false") << "}"
+			<< (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	out << "  ]\n}\n";
+}
+
+//just enough of a JSON reader for the files WriteJson makes: the name, wall_ms and allocations
+//of every object in the benchmarks array
+struct BaselineEntry
+{
+	std::string name;
+	double wallMs = 0;
+	double allocations = 0;
+};
+
+static std::vector<BaselineEntry> ReadBaseline(const std::string& path)
+{
+	std::ifstream file(path);
+	std::stringstream contents;
+	contents << file.rdbuf();
+	std::string text = contents.str();
+
+	std::vector<BaselineEntry> entries;
+	size_t position = text.find("\"benchmarks\"");
+	while (position != std::string::npos)
+	{
+		size_t open = text.find('{', position);
+		if (open == std::string::npos) break;
+		size_t close = text.find('}', open);
+		if (close == std::string::npos) break;
+		std::string object = text.substr(open, close - open);
+
+		auto field = [&object](const std::string& key) -> std::string
+		{
+			size_t at = object.find("\"" + key + "\"");
+			if (at == std::string::npos) return std::string();
+			at = object.find(':', at);
+			if (at == std::string::npos) return std::string();
+			size_t end = object.find_first_of(",}", at);
+			std::string value = object.substr(at + 1, end == std::string::npos ? std::string::npos : end - at - 1);
+			value.erase(0, value.find_first_not_of(" \t\n\""));
+			value.erase(value.find_last_not_of(" \t\n\"") + 1);
+			return value;
+		};
+
+		BaselineEntry entry;
+		entry.name = field("name");
+		entry.wallMs = std::atof(field("wall_ms").c_str());
+		entry.allocations = std::atof(field("allocations").c_str());
+		if (!entry.name.empty()) entries.push_back(entry);
+		position = close;
+	}
+	return entries;
+}
+
+//prints the comparison to stderr, true if any benchmark regressed
+static bool Compare(const std::vector<Result>& results, const std::vector<BaselineEntry>& baseline, double threshold)
+{
+	bool regressed = false;
+	std::cerr << std::fixed << std::setprecision(1);
+	std::cerr << std::left << std::setw(14) << "benchmark" << std::right << std::setw(12) << "baseline ms"
+		<< std::setw(12) << "current ms" << std::setw(9) << "time" << std::setw(9) << "allocs" << "\n";
+	for (const Result& result : results)
+	{
+		auto found = std::find_if(baseline.begin(), baseline.end(),
+			[&result](const BaselineEntry& entry) { return entry.name == result.name; });
+		std::cerr << std::left << std::setw(14) << result.name << std::right;
+		if (found == baseline.end())
+		{
+			std::cerr << std::setw(12) << "-" << std::setw(12) << result.wallMs << "   new\n";
+			continue;
+		}
+
+		double timeChange = found->wallMs > 0 ? (result.wallMs / found->wallMs - 1) * 100 : 0;
+		double allocationChange = found->allocations > 0 ? (result.allocations / found->allocations - 1) * 100 : 0;
+		bool slower = timeChange > threshold || allocationChange > threshold;
+		regressed = regressed || slower || result.failed;
+		std::cerr << std::setw(12) << found->wallMs << std::setw(12) << result.wallMs
+			<< std::setw(8) << std::showpos << timeChange << "%" << std::setw(8) << allocationChange << "%" << std::noshowpos
+			<< (result.failed ? "   FAILED" : slower ? "   REGRESSION" : "") << "\n";
+	}
+	return regressed;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string suiteDirectory = LOX_BENCH_SUITE;
+	std::string outPath;
+	std::string baselinePath;
+	int repeat = 3;
+	double threshold = 10;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--suite" && hasValue) suiteDirectory = argv[++i];
+		else if (arg == "--out" && hasValue) outPath = argv[++i];
+		else if (arg == "--baseline" && hasValue) baselinePath = argv[++i];
+		else if (arg == "--repeat" && hasValue) repeat = std::max(1, std::atoi(argv[++i]));
+		else if (arg == "--threshold" && hasValue) threshold = std::atof(argv[++i]);
+		else
+		{
+			std::cerr << "Usage: " << argv[0] << " [--suite dir] [--repeat n] [--out results.json] [--baseline results.json] [--threshold percent]\n";
+			return 1;
+		}
+	}
+
+	std::vector<Benchmark> suite = LoadSuite(suiteDirectory);
+	if (suite.empty())
+	{
+		std::cerr << "no .lox programs in " << suiteDirectory << "\n";
+		return 1;
+	}
+	suite.push_back(LargeParse(50000));
+
+	//the fastest of the repeats, allocations and peak memory do not change between them
+	std::vector<Result> results;
+	for (const Benchmark& benchmark : suite)
+	{
+		Result best = Run(benchmark);
+		for (int i = 1; i < repeat; ++i)
+		{
+			Result next = Run(benchmark);
+			if (next.wallMs < best.wallMs) best = next;
+		}
+		std::cerr << benchmark.name << ": " << best.wallMs << " ms" << (best.failed ? " (failed)" : "") << "\n";
+		results.push_back(best);
+	}
+
+	if (outPath.empty()) WriteJson(std::cout, results, repeat);
+	else
+	{
+		std::ofstream out(outPath);
+		WriteJson(out, results, repeat);
+	}
+
+	if (baselinePath.empty()) return 0;
+	std::vector<BaselineEntry> baseline = ReadBaseline(baselinePath);
+	if (baseline.empty())
+	{
+		std::cerr << "could not read a baseline from " << baselinePath << "\n";
+		return 1;
+	}
+	return Compare(results, baseline, threshold) ? 1 : 0;
+}
@@ -0,0 +1,40 @@
+#include "Arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+void* Arena::Allocate(size_t size, size_t alignment)
+{
+	auto address = reinterpret_cast<uintptr_t>(cursor);
+	size_t padding = (alignment - address % alignment) % alignment;
+	if (cursor == nullptr || padding + size > static_cast<size_t>(end - cursor))
+	{
+		//oversized requests get a block of their own, the current block keeps serving small ones
+		if (size + alignment > blockSize)
+		{
+			blocks.emplace_back(new char[size + alignment]);
+			auto start = reinterpret_cast<uintptr_t>(blocks.back().get());
+			bytesUsed += size;
+			return reinterpret_cast<void*>(start + (alignment - start % alignment) % alignment);
+		}
+		blocks.emplace_back(new char[blockSize]);
+		cursor = blocks.back().get();
+		end = cursor + blockSize;
+		blockSize = std::min(blockSize * 2, maxBlockSize);
+		address = reinterpret_cast<uintptr_t>(cursor);
+		padding = (alignment - address % alignment) % alignment;
+	}
+
+	char* result = cursor + padding;
+	cursor = result + size;
+	bytesUsed += size;
+	return result;
+}
+
+std::string_view Arena::CopyString(std::string_view text)
+{
+	if (text.empty()) return {};
+	auto memory = static_cast<char*>(Allocate(text.size(), 1));
+	std::memcpy(memory, text.data(), text.size());
+	return std::string_view(memory, text.size());
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+//deleter for objects that live in an Arena: runs the destructor but leaves the memory to the arena
+struct ArenaDeleter
+{
+	template <typename T>
+	void operator()(T* object) const { object->~T(); }
+};
+
+template <typename T>
+using ArenaPtr = std::unique_ptr<T, ArenaDeleter>;
+
+//bump allocator that owns the AST of one parse. nodes and the lexemes they keep are carved
+//out of large blocks which are all released at once when the arena is destroyed.
+//the arena must outlive every ArenaPtr made from it.
+//an arena for a small parse can start with a smaller block, each next one is twice as large
+//up to maxBlockSize
+class Arena
+{
+public:
+	static constexpr size_t maxBlockSize = 64 * 1024;
+
+	explicit Arena(size_t blockSize = maxBlockSize) : blockSize(blockSize < maxBlockSize ? blockSize : maxBlockSize) {}
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	void* Allocate(size_t size, size_t alignment);
+
+	template <typename T, typename... Args>
+	ArenaPtr<T> Make(Args&&... args)
+	{
+		void* memory = Allocate(sizeof(T), alignof(T));
+		return ArenaPtr<T>(new (memory) T(std::forward<Args>(args)...));
+	}
+
+	//copies text into the arena so it stays valid after the source buffer is gone
+	std::string_view CopyString(std::string_view text);
+
+	size_t BytesUsed() const { return bytesUsed; }
+
+private:
+	std::vector<std::unique_ptr<char[]>> blocks;
+	char* cursor = nullptr;
+	char* end = nullptr;
+	size_t blockSize;
+	size_t bytesUsed = 0;
+};
@@ -0,0 +1,458 @@
+#include "AstCache.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace
+{
+	const char magic[4] = { 'L', 'O', 'X', 'C' };
+	//bump when the layout of the nodes changes
+	const uint32_t version = 1;
+	//reads back differently on a machine with the other byte order
+	const uint32_t byteOrder = 0x01020304;
+
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t byteOrder;
+		uint32_t stringCount;
+		uint64_t sourceHash;
+		uint64_t sourceSize;
+		uint64_t contentHash; //of everything after the header, catches a damaged file
+		uint32_t statementCount;
+		uint32_t reserved;
+	};
+
+	//one tag per node kind, Null for a missing else branch or initializer. a failed parse is never
+	//saved, so that is the only place a node may be left out
+	enum class NodeTag : uint8_t
+	{
+		Null,
+		Binary,
+		Grouping,
+		Literal,
+		Unary,
+		Variable,
+		Assign,
+		Logical,
+		Expression,
+		Print,
+		Var,
+		Block,
+		If,
+		While
+	};
+
+	enum class LiteralTag : uint8_t
+	{
+		Nil,
+		False,
+		True,
+		Number,
+		String
+	};
+
+	class AstWriter : public Expr::Visitor, public Stmt::Visitor
+	{
+	public:
+		void Write(const std::vector<StmtPtr>& statements)
+		{
+			for (const auto& statement : statements) Write(statement.get());
+		}
+
+		std::vector<std::string_view> strings;
+		std::string nodes;
+
+		//expr visitor methods
+		void VisitBinaryExpr(BinaryExpr& expr) override
+		{
+			Put(NodeTag::Binary);
+			Write(expr.left.get());
+			Put(expr.op);
+			Write(expr.right.get());
+		}
+		void VisitGroupingExpr(GroupingExpr& expr) override
+		{
+			Put(NodeTag::Grouping);
+			Write(expr.expression.get());
+		}
+		void VisitLiteralExpr(LiteralExpr& expr) override
+		{
+			Put(NodeTag::Literal);
+			const LoxValue& value = expr.value;
+			if (IsNumber(value))
+			{
+				Put(LiteralTag::Number);
+				Put(AsNumber(value));
+			}
+			else if (IsString(value))
+			{
+				Put(LiteralTag::String);
+				Put(AsString(value));
+			}
+			else if (IsBool(value)) Put(AsBool(value) ? LiteralTag::True : LiteralTag::False);
+			else Put(LiteralTag::Nil);
+		}
+		void VisitUnaryExpr(UnaryExpr& expr) override
+		{
+			Put(NodeTag::Unary);
+			Put(expr.op);
+			Write(expr.right.get());
+		}
+		void VisitVariableExpr(VariableExpr& expr) override
+		{
+			Put(NodeTag::Variable);
+			Put(expr.name);
+		}
+		void VisitAssignExpr(AssignExpr& expr) override
+		{
+			Put(NodeTag::Assign);
+			Put(expr.name);
+			Write(expr.value.get());
+		}
+		void VisitLogicalExpr(LogicalExpr& expr) override
+		{
+			Put(NodeTag::Logical);
+			Write(expr.left.get());
+			Put(expr.op);
+			Write(expr.right.get());
+		}
+		//superinstructions only exist after the Fuser, the cache is written before it runs
+		void VisitIncrementExpr(IncrementExpr& expr) override { Write(expr.original.get()); }
+		void VisitCompareExpr(CompareExpr& expr) override { Write(expr.original.get()); }
+
+		//stmt visitor methods
+		void VisitExpressionStmt(ExpressionStmt& stmt) override
+		{
+			Put(NodeTag::Expression);
+			Write(stmt.expression.get());
+		}
+		void VisitPrintStmt(PrintStmt& stmt) override
+		{
+			Put(NodeTag::Print);
+			Write(stmt.expression.get());
+		}
+		void VisitVarStmt(VarStmt& stmt) override
+		{
+			Put(NodeTag::Var);
+			Put(stmt.name);
+			Write(stmt.initializer.get());
+		}
+		void VisitBlockStmt(BlockStmt& stmt) override
+		{
+			Put(NodeTag::Block);
+			Put(static_cast<uint32_t>(stmt.statements.size()));
+			Write(stmt.statements);
+		}
+		void VisitIfStmt(IfStmt& stmt) override
+		{
+			Put(NodeTag::If);
+			Write(stmt.condition.get());
+			Write(stmt.thenBranch.get());
+			Write(stmt.elseBranch.get());
+		}
+		void VisitWhileStmt(WhileStmt& stmt) override
+		{
+			Put(NodeTag::While);
+			Write(stmt.condition.get());
+			Write(stmt.body.get());
+		}
+
+	private:
+		void Write(Expr* expr)
+		{
+			if (expr) expr->Accept(*this);
+			else Put(NodeTag::Null);
+		}
+		void Write(Stmt* stmt)
+		{
+			if (stmt) stmt->Accept(*this);
+			else Put(NodeTag::Null);
+		}
+
+		template <typename T>
+		void Put(T value)
+		{
+			nodes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+		}
+		//strings go in the table once, nodes refer to them by index
+		void Put(std::string_view text)
+		{
+			auto found = stringIndex.find(text);
+			uint32_t index;
+			if (found != stringIndex.end()) index = found->second;
+			else
+			{
+				index = static_cast<uint32_t>(strings.size());
+				strings.push_back(text);
+				stringIndex.emplace(text, index);
+			}
+			Put(index);
+		}
+		void Put(const std::string& text) { Put(std::string_view(text)); }
+		//identifiers get their name back as the literal on reading, no other kept token has one
+		void Put(const Token& token)
+		{
+			Put(token.type);
+			Put(static_cast<uint32_t>(token.line));
+			Put(token.lexeme);
+		}
+
+		std::unordered_map<std::string_view, uint32_t> stringIndex;
+	};
+
+	//every read is bounds checked, a short or damaged file sets failed instead of reading past the end
+	class AstReader
+	{
+	public:
+		AstReader(std::string_view data, Arena& arena) : cursor(data.data()), end(data.data() + data.size()), arena(arena) {}
+
+		bool failed = false;
+
+		bool AtEnd() const { return cursor == end; }
+
+		template <typename T>
+		T Get()
+		{
+			T value{};
+			if (static_cast<size_t>(end - cursor) < sizeof(value))
+			{
+				failed = true;
+				return value;
+			}
+			std::memcpy(&value, cursor, sizeof(value));
+			cursor += sizeof(value);
+			return value;
+		}
+
+		void ReadStrings(uint32_t count)
+		{
+			strings.reserve(count);
+			for (uint32_t i = 0; i < count && !failed; ++i)
+			{
+				uint32_t length = Get<uint32_t>();
+				if (static_cast<size_t>(end - cursor) < length)
+				{
+					failed = true;
+					return;
+				}
+				strings.push_back(arena.CopyString(std::string_view(cursor, length)));
+				cursor += length;
+			}
+		}
+
+		//a damaged file could leave a hole where the tree needs a node, only optional places may be null
+		StmtPtr ReadStmt(bool optional = false)
+		{
+			switch (Get<NodeTag>())
+			{
+			case NodeTag::Null:
+				failed = failed || !optional;
+				return nullptr;
+			case NodeTag::Expression:
+				return Make<ExpressionStmt>(ReadExpr());
+			case NodeTag::Print:
+				return Make<PrintStmt>(ReadExpr());
+			case NodeTag::Var:
+			{
+				Token name = GetToken();
+				return Make<VarStmt>(name, ReadExpr(true));
+			}
+			case NodeTag::Block:
+			{
+				uint32_t count = Get<uint32_t>();
+				std::vector<StmtPtr> statements;
+				for (uint32_t i = 0; i < count && !failed; ++i) statements.push_back(ReadStmt());
+				return Make<BlockStmt>(std::move(statements));
+			}
+			case NodeTag::If:
+			{
+				ExprPtr condition = ReadExpr();
+				StmtPtr thenBranch = ReadStmt();
+				return Make<IfStmt>(std::move(condition), std::move(thenBranch), ReadStmt(true));
+			}
+			case NodeTag::While:
+			{
+				ExprPtr condition = ReadExpr();
+				return Make<WhileStmt>(std::move(condition), ReadStmt());
+			}
+			default:
+				failed = true;
+				return nullptr;
+			}
+		}
+
+		ExprPtr ReadExpr(bool optional = false)
+		{
+			switch (Get<NodeTag>())
+			{
+			case NodeTag::Null:
+				failed = failed || !optional;
+				return nullptr;
+			case NodeTag::Binary:
+			{
+				ExprPtr left = ReadExpr();
+				Token op = GetToken();
+				return Make<BinaryExpr>(std::move(left), op, ReadExpr());
+			}
+			case NodeTag::Grouping:
+				return Make<GroupingExpr>(ReadExpr());
+			case NodeTag::Literal:
+				return Make<LiteralExpr>(GetLiteral());
+			case NodeTag::Unary:
+			{
+				Token op = GetToken();
+				return Make<UnaryExpr>(op, ReadExpr());
+			}
+			case NodeTag::Variable:
+				return Make<VariableExpr>(GetToken());
+			case NodeTag::Assign:
+			{
+				Token name = GetToken();
+				return Make<AssignExpr>(name, ReadExpr());
+			}
+			case NodeTag::Logical:
+			{
+				ExprPtr left = ReadExpr();
+				Token op = GetToken();
+				return Make<LogicalExpr>(std::move(left), op, ReadExpr());
+			}
+			default:
+				failed = true;
+				return nullptr;
+			}
+		}
+
+	private:
+		//stops building once something went wrong, the caller throws the whole tree away
+		template <typename T, typename... Args>
+		ArenaPtr<T> Make(Args&&... args)
+		{
+			if (failed) return nullptr;
+			return arena.Make<T>(std::forward<Args>(args)...);
+		}
+
+		std::string_view GetString()
+		{
+			uint32_t index = Get<uint32_t>();
+			if (index >= strings.size())
+			{
+				failed = true;
+				return std::string_view();
+			}
+			return strings[index];
+		}
+
+		Token GetToken()
+		{
+			TokenType type = Get<TokenType>();
+			int line = static_cast<int>(Get<uint32_t>());
+			std::string_view lexeme = GetString();
+			LoxValue literal = type == TokenType::IDENTIFIER ? InternString(lexeme) : LoxValue();
+			return Token(type, lexeme, std::move(literal), line);
+		}
+
+		LoxValue GetLiteral()
+		{
+			switch (Get<LiteralTag>())
+			{
+			case LiteralTag::Nil: return LoxValue();
+			case LiteralTag::False: return false;
+			case LiteralTag::True: return true;
+			case LiteralTag::Number: return Get<double>();
+			case LiteralTag::String: return InternString(GetString());
+			default:
+				failed = true;
+				return LoxValue();
+			}
+		}
+
+		const char* cursor;
+		const char* end;
+		Arena& arena;
+		std::vector<std::string_view> strings;
+	};
+}
+
+uint64_t AstCache::Hash(std::string_view source)
+{
+	//FNV-1a taken eight bytes at a time, with a shift so the high bits of a word reach the low
+	//bits of the hash. only has to notice an edited script, and must cost far less than scanning
+	const uint64_t prime = 1099511628211ull;
+	uint64_t hash = 14695981039346656037ull ^ source.size();
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= source.size(); i += sizeof(uint64_t))
+	{
+		uint64_t word;
+		std::memcpy(&word, source.data() + i, sizeof(word));
+		hash = (hash ^ word) * prime;
+		hash ^= hash >> 29;
+	}
+	for (; i < source.size(); ++i)
+	{
+		hash = (hash ^ static_cast<unsigned char>(source[i])) * prime;
+	}
+	return hash;
+}
+
+bool AstCache::Write(const std::string& path, std::string_view source, const std::vector<StmtPtr>& statements)
+{
+	AstWriter writer;
+	writer.Write(statements);
+
+	Header header{};
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	header.byteOrder = byteOrder;
+	header.stringCount = static_cast<uint32_t>(writer.strings.size());
+	header.sourceHash = Hash(source);
+	header.sourceSize = source.size();
+	header.statementCount = static_cast<uint32_t>(statements.size());
+
+	std::string content;
+	for (std::string_view text : writer.strings)
+	{
+		uint32_t length = static_cast<uint32_t>(text.size());
+		content.append(reinterpret_cast<const char*>(&length), sizeof(length));
+		content.append(text);
+	}
+	content.append(writer.nodes);
+	header.contentHash = Hash(content);
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out) return false;
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(content.data(), content.size());
+	return static_cast<bool>(out);
+}
+
+bool AstCache::Read(const std::string& path, std::string_view source, Arena& arena, std::vector<StmtPtr>& statements)
+{
+	MappedFile file(path);
+	if (!file.IsOpen()) return false;
+
+	AstReader reader(file.Contents(), arena);
+	Header header = reader.Get<Header>();
+	if (reader.failed || std::memcmp(header.magic, magic, sizeof(magic)) != 0
+		|| header.version != version || header.byteOrder != byteOrder
+		|| header.sourceSize != source.size() || header.sourceHash != Hash(source)
+		|| header.contentHash != Hash(file.Contents().substr(sizeof(header))))
+	{
+		return false;
+	}
+
+	reader.ReadStrings(header.stringCount);
+	for (uint32_t i = 0; i < header.statementCount && !reader.failed; ++i)
+	{
+		statements.push_back(reader.ReadStmt());
+	}
+	//a file cut short, or with bytes after the last node, was not written whole
+	if (reader.failed || !reader.AtEnd())
+	{
+		statements.clear();
+		return false;
+	}
+	return true;
+}
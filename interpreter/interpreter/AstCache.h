@@ -0,0 +1,28 @@
+#pragma once
+#include "Stmt.h"
+#include "Arena.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//binary image of a parsed program, kept next to the script so a later run can skip scanning and
+//parsing. it holds the tree as the Parser returned it, before any pass has touched it: nodes in
+//pre-order, the tokens they keep, their literals and line numbers, with every lexeme and string
+//constant stored once in a table up front. the header records a hash and the length of the
+//source it was made from, a cache that does not match is ignored.
+//numbers are written in the byte order of the machine, the version check rejects other layouts.
+class AstCache
+{
+public:
+	static uint64_t Hash(std::string_view source);
+
+	//false if the file could not be written, the run goes on without a cache
+	static bool Write(const std::string& path, std::string_view source, const std::vector<StmtPtr>& statements);
+
+	//maps the cache and rebuilds the tree in the arena. false, with statements left empty, when
+	//there is no cache, it was made from a different source or it is damaged.
+	//lexemes are copied into the arena, nothing points into the cache afterwards
+	static bool Read(const std::string& path, std::string_view source, Arena& arena, std::vector<StmtPtr>& statements);
+};
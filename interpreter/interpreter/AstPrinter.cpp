@@ -7,11 +7,23 @@ std::string AstPrinter::Print(Expr& expr)
 	return output.c_str();
 }
 
+std::string AstPrinter::Print(const std::vector<StmtPtr>& statements)
+{
+	output.clear();
+	for (const auto& statement : statements)
+	{
+		if (!statement) continue; //skipping null statements
+		statement->Accept(*this);
+		output += "\n";
+	}
+	return output;
+}
+
 //visitor implementations
 
 void AstPrinter::VisitBinaryExpr(BinaryExpr& expr)
 {
-	Parenthesise(expr.op.lexeme, *expr.left, *expr.right);
+	Parenthesise(std::string(expr.op.lexeme), *expr.left, *expr.right);
 }
 
 void AstPrinter::VisitGroupingExpr(GroupingExpr& expr)
@@ -21,23 +33,106 @@ void AstPrinter::VisitGroupingExpr(GroupingExpr& expr)
 
 void AstPrinter::VisitLiteralExpr(LiteralExpr& expr)
 {
-	if (std::holds_alternative<std::monostate>(expr.value)) {
+	if (IsNil(expr.value)) {
 		output += "nil";
 	}
-	else if (std::holds_alternative<double>(expr.value)) {
-		output += std::to_string(std::get<double>(expr.value));
+	else if (IsNumber(expr.value)) {
+		output += Stringify(expr.value);
 	}
-	else if (std::holds_alternative<std::string>(expr.value)) {
-		output += std::get<std::string>(expr.value);
+	else if (IsString(expr.value)) {
+		output += "\"" + std::string(AsString(expr.value)) + "\"";
 	}
-	else if (std::holds_alternative<bool>(expr.value)) {
-		output += std::get<bool>(expr.value) ? "true" : "false";
+	else if (IsBool(expr.value)) {
+		output += AsBool(expr.value) ? "true" : "false";
 	}
 }
 
 void AstPrinter::VisitUnaryExpr(UnaryExpr& expr)
 {
-	Parenthesise(expr.op.lexeme, *expr.right);
+	Parenthesise(std::string(expr.op.lexeme), *expr.right);
+}
+
+void AstPrinter::VisitVariableExpr(VariableExpr& expr)
+{
+	output += expr.name.lexeme;
+}
+
+void AstPrinter::VisitAssignExpr(AssignExpr& expr)
+{
+	Parenthesise("= " + std::string(expr.name.lexeme), *expr.value);
+}
+
+void AstPrinter::VisitLogicalExpr(LogicalExpr& expr)
+{
+	Parenthesise(std::string(expr.op.lexeme), *expr.left, *expr.right);
+}
+
+void AstPrinter::VisitIncrementExpr(IncrementExpr& expr)
+{
+	Parenthesise("increment", *expr.original);
+}
+
+void AstPrinter::VisitCompareExpr(CompareExpr& expr)
+{
+	Parenthesise("compare", *expr.original);
+}
+
+//stmt visitor methods
+
+void AstPrinter::VisitExpressionStmt(ExpressionStmt& stmt)
+{
+	Parenthesise(";", *stmt.expression);
+}
+
+void AstPrinter::VisitPrintStmt(PrintStmt& stmt)
+{
+	Parenthesise("print", *stmt.expression);
+}
+
+void AstPrinter::VisitVarStmt(VarStmt& stmt)
+{
+	std::string name = "var " + std::string(stmt.name.lexeme);
+	if (stmt.initializer)
+	{
+		Parenthesise(name, *stmt.initializer);
+		return;
+	}
+	output += "(" + name + ")";
+}
+
+void AstPrinter::VisitBlockStmt(BlockStmt& stmt)
+{
+	output += "(block";
+	for (const auto& statement : stmt.statements)
+	{
+		if (!statement) continue; //skipping null statements
+		output += " ";
+		statement->Accept(*this);
+	}
+	output += ")";
+}
+
+void AstPrinter::VisitIfStmt(IfStmt& stmt)
+{
+	output += "(if ";
+	stmt.condition->Accept(*this);
+	output += " ";
+	stmt.thenBranch->Accept(*this);
+	if (stmt.elseBranch)
+	{
+		output += " ";
+		stmt.elseBranch->Accept(*this);
+	}
+	output += ")";
+}
+
+void AstPrinter::VisitWhileStmt(WhileStmt& stmt)
+{
+	output += "(while ";
+	stmt.condition->Accept(*this);
+	output += " ";
+	stmt.body->Accept(*this);
+	output += ")";
 }
 
 //helper methods
@@ -1,15 +1,33 @@
 #pragma once
 #include "Expr.h"
+#include "Stmt.h"
 #include <vector>
 #include <string>
-class AstPrinter : public Expr::Visitor
+//prints the AST as s-expressions, one line per top level statement
+class AstPrinter : public Expr::Visitor, public Stmt::Visitor
 {
 public:
 	std::string Print(Expr& expr);
+	std::string Print(const std::vector<StmtPtr>& statements);
+
+	//expr visitor methods
 	void VisitBinaryExpr(BinaryExpr& expr) override;
 	void VisitGroupingExpr(GroupingExpr& expr) override;
 	void VisitLiteralExpr(LiteralExpr& expr) override;
 	void VisitUnaryExpr(UnaryExpr& expr) override;
+	void VisitVariableExpr(VariableExpr& expr) override;
+	void VisitAssignExpr(AssignExpr& expr) override;
+	void VisitLogicalExpr(LogicalExpr& expr) override;
+	void VisitIncrementExpr(IncrementExpr& expr) override;
+	void VisitCompareExpr(CompareExpr& expr) override;
+
+	//stmt visitor methods
+	void VisitExpressionStmt(ExpressionStmt& stmt) override;
+	void VisitPrintStmt(PrintStmt& stmt) override;
+	void VisitVarStmt(VarStmt& stmt) override;
+	void VisitBlockStmt(BlockStmt& stmt) override;
+	void VisitIfStmt(IfStmt& stmt) override;
+	void VisitWhileStmt(WhileStmt& stmt) override;
 
 private:
 	void Parenthesise(const std::string& name, Expr& expr);
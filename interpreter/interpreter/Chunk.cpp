@@ -0,0 +1,43 @@
+#include "Chunk.h"
+#include <algorithm>
+#include <cstring>
+
+void Chunk::Write(uint8_t byte, int line)
+{
+	//only record a new entry when the line changes
+	if (lines.empty() || lines.back().line != line)
+	{
+		lines.push_back({ code.size(), line });
+	}
+	code.push_back(byte);
+}
+
+int Chunk::AddConstant(const LoxValue& value)
+{
+	//reuse the slot of a repeated string or number, global names are looked up by every access
+	//and a generated script repeats the same few numbers all over
+	if (IsString(value))
+	{
+		auto iter = stringConstants.find(value);
+		if (iter != stringConstants.end()) return iter->second;
+		stringConstants[value] = static_cast<int>(constants.size());
+	}
+	else if (IsNumber(value))
+	{
+		double number = AsNumber(value);
+		uint64_t bits;
+		std::memcpy(&bits, &number, sizeof(bits));
+		auto [iter, added] = numberConstants.try_emplace(bits, static_cast<int>(constants.size()));
+		if (!added) return iter->second;
+	}
+	constants.push_back(value);
+	return static_cast<int>(constants.size() - 1);
+}
+
+int Chunk::GetLine(size_t offset) const
+{
+	auto iter = std::upper_bound(lines.begin(), lines.end(), offset,
+		[](size_t value, const LineStart& start) { return value < start.offset; });
+	if (iter == lines.begin()) return 0;
+	return std::prev(iter)->line;
+}
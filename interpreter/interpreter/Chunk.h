@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "Value.h"
+
+//instruction set of the bytecode vm. operands follow the opcode in the code stream:
+//constant/global indices are 2 bytes, local slots 1 byte, jump offsets 2 bytes.
+//the _LONG forms take 3 bytes, for large scripts
+enum class OpCode : uint8_t
+{
+	CONSTANT, CONSTANT_LONG,
+	NIL, TRUE, FALSE,
+	POP,
+	GET_LOCAL, SET_LOCAL,
+	GET_GLOBAL, DEFINE_GLOBAL, SET_GLOBAL,
+	GET_GLOBAL_LONG, DEFINE_GLOBAL_LONG, SET_GLOBAL_LONG,
+	EQUAL, NOT_EQUAL,
+	GREATER, GREATER_EQUAL, LESS, LESS_EQUAL,
+	ADD, SUBTRACT, MULTIPLY, DIVIDE,
+	NOT, NEGATE,
+	PRINT,
+	JUMP, JUMP_IF_FALSE, LOOP,
+	JUMP_LONG, JUMP_IF_FALSE_LONG, LOOP_LONG,
+	RETURN
+};
+
+//a flat block of bytecode with its constant pool and a run-length encoded line table
+class Chunk
+{
+public:
+	std::vector<uint8_t> code;
+	std::vector<LoxValue> constants;
+
+	void Write(uint8_t byte, int line);
+	void Write(OpCode op, int line) { Write(static_cast<uint8_t>(op), line); }
+	int AddConstant(const LoxValue& value);
+	//source line of the instruction at offset
+	int GetLine(size_t offset) const;
+
+private:
+	struct LineStart
+	{
+		size_t offset;
+		int line;
+	};
+	std::vector<LineStart> lines;
+	std::unordered_map<LoxValue, int, LoxValueHash, LoxValueEqual> stringConstants;
+	//keyed by the bits of the number, so 0 and -0 get slots of their own
+	std::unordered_map<uint64_t, int> numberConstants;
+};
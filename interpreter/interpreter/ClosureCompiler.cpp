@@ -0,0 +1,390 @@
+#include "ClosureCompiler.h"
+#include <iostream>
+#include "RuntimeError.h"
+
+static const char* numbersMessage = "Operands must be numbers.";
+static const char* plusMessage = "Operands must be two numbers or two strings.";
+
+//closure for an arithmetic or comparison operator on two numbers
+template <typename Operation>
+static ExprClosure NumberBinary(ExprClosure left, ExprClosure right, const Token& op, const char* message, Operation operation)
+{
+	return [left = std::move(left), right = std::move(right), op, message, operation](ClosureState& state) -> LoxValue
+	{
+		LoxValue a = left(state);
+		LoxValue b = right(state);
+		if (!IsNumber(a) || !IsNumber(b)) throw RuntimeError(op, message);
+		return operation(AsNumber(a), AsNumber(b));
+	};
+}
+
+//same, with a number literal on the right bound into the closure
+template <typename Operation>
+static ExprClosure NumberConstant(ExprClosure left, double constant, const Token& op, const char* message, Operation operation)
+{
+	return [left = std::move(left), constant, op, message, operation](ClosureState& state) -> LoxValue
+	{
+		LoxValue a = left(state);
+		if (!IsNumber(a)) throw RuntimeError(op, message);
+		return operation(AsNumber(a), constant);
+	};
+}
+
+bool ClosureCompiler::Interpret(const std::vector<StmtPtr>& statements)
+{
+	std::vector<StmtClosure> program = Compile(statements);
+	try
+	{
+		for (const auto& statement : program)
+		{
+			statement(state);
+		}
+	}
+	catch (const RuntimeError& error)
+	{
+		output.Flush();
+		std::cerr << "[line " << error.getToken().line << "] RuntimeError: "
+			<< error.what() << "\n";
+		return false;
+	}
+	return true;
+}
+
+//expr visitor methods
+void ClosureCompiler::VisitBinaryExpr(BinaryExpr& expr)
+{
+	ExprClosure left = Compile(*expr.left);
+	const Token& op = expr.op;
+
+	//a number literal on the right, as in i < 10 or i + 1, needs no closure of its own
+	auto literal = dynamic_cast<LiteralExpr*>(expr.right.get());
+	if (literal && IsNumber(literal->value))
+	{
+		double constant = AsNumber(literal->value);
+		switch (op.type)
+		{
+		case TokenType::PLUS:
+			compiledExpr = NumberConstant(std::move(left), constant, op, plusMessage, [](double a, double b) { return LoxValue(a + b); });
+			return;
+		case TokenType::MINUS:
+			compiledExpr = NumberConstant(std::move(left), constant, op, numbersMessage, [](double a, double b) { return LoxValue(a - b); });
+			return;
+		case TokenType::STAR:
+			compiledExpr = NumberConstant(std::move(left), constant, op, numbersMessage, [](double a, double b) { return LoxValue(a * b); });
+			return;
+		case TokenType::SLASH:
+			//dividing by a literal zero keeps the general closure and its error
+			if (constant == 0) break;
+			compiledExpr = NumberConstant(std::move(left), constant, op, numbersMessage, [](double a, double b) { return LoxValue(a / b); });
+			return;
+		case TokenType::GREATER:
+			compiledExpr = NumberConstant(std::move(left), constant, op, numbersMessage, [](double a, double b) { return LoxValue(a > b); });
+			return;
+		case TokenType::GREATER_EQUAL:
+			compiledExpr = NumberConstant(std::move(left), constant, op, numbersMessage, [](double a, double b) { return LoxValue(a >= b); });
+			return;
+		case TokenType::LESS:
+			compiledExpr = NumberConstant(std::move(left), constant, op, numbersMessage, [](double a, double b) { return LoxValue(a < b); });
+			return;
+		case TokenType::LESS_EQUAL:
+			compiledExpr = NumberConstant(std::move(left), constant, op, numbersMessage, [](double a, double b) { return LoxValue(a <= b); });
+			return;
+		default:
+			break;
+		}
+	}
+
+	ExprClosure right = Compile(*expr.right);
+	switch (op.type)
+	{
+	case TokenType::PLUS:
+		compiledExpr = [left = std::move(left), right = std::move(right), op](ClosureState& state) -> LoxValue
+		{
+			LoxValue a = left(state);
+			LoxValue b = right(state);
+			if (IsNumber(a) && IsNumber(b)) return AsNumber(a) + AsNumber(b);
+			if (IsString(a) && IsString(b)) return Concatenate(a, b);
+			throw RuntimeError(op, plusMessage);
+		};
+		break;
+	case TokenType::MINUS:
+		compiledExpr = NumberBinary(std::move(left), std::move(right), op, numbersMessage, [](double a, double b) { return LoxValue(a - b); });
+		break;
+	case TokenType::STAR:
+		compiledExpr = NumberBinary(std::move(left), std::move(right), op, numbersMessage, [](double a, double b) { return LoxValue(a * b); });
+		break;
+	case TokenType::SLASH:
+		compiledExpr = NumberBinary(std::move(left), std::move(right), op, numbersMessage, [op](double a, double b)
+		{
+			if (b == 0) throw RuntimeError(op, "Division by zero.");
+			return LoxValue(a / b);
+		});
+		break;
+	case TokenType::GREATER:
+		compiledExpr = NumberBinary(std::move(left), std::move(right), op, numbersMessage, [](double a, double b) { return LoxValue(a > b); });
+		break;
+	case TokenType::GREATER_EQUAL:
+		compiledExpr = NumberBinary(std::move(left), std::move(right), op, numbersMessage, [](double a, double b) { return LoxValue(a >= b); });
+		break;
+	case TokenType::LESS:
+		compiledExpr = NumberBinary(std::move(left), std::move(right), op, numbersMessage, [](double a, double b) { return LoxValue(a < b); });
+		break;
+	case TokenType::LESS_EQUAL:
+		compiledExpr = NumberBinary(std::move(left), std::move(right), op, numbersMessage, [](double a, double b) { return LoxValue(a <= b); });
+		break;
+	case TokenType::BANG_EQUAL:
+		compiledExpr = [left = std::move(left), right = std::move(right)](ClosureState& state) -> LoxValue
+		{
+			LoxValue a = left(state);
+			return !IsEqual(a, right(state));
+		};
+		break;
+	case TokenType::EQUAL_EQUAL:
+		compiledExpr = [left = std::move(left), right = std::move(right)](ClosureState& state) -> LoxValue
+		{
+			LoxValue a = left(state);
+			return IsEqual(a, right(state));
+		};
+		break;
+	default:
+		compiledExpr = [op](ClosureState&) -> LoxValue { throw RuntimeError(op, "Unknown binary operator."); };
+		break;
+	}
+}
+
+void ClosureCompiler::VisitGroupingExpr(GroupingExpr& expr)
+{
+	compiledExpr = Compile(*expr.expression);
+}
+
+void ClosureCompiler::VisitLiteralExpr(LiteralExpr& expr)
+{
+	compiledExpr = [value = expr.value](ClosureState&) { return value; };
+}
+
+void ClosureCompiler::VisitUnaryExpr(UnaryExpr& expr)
+{
+	ExprClosure right = Compile(*expr.right);
+	switch (expr.op.type)
+	{
+	case TokenType::MINUS:
+		compiledExpr = [right = std::move(right), op = expr.op](ClosureState& state) -> LoxValue
+		{
+			LoxValue value = right(state);
+			if (!IsNumber(value)) throw RuntimeError(op, "Operand must be a number.");
+			return -AsNumber(value);
+		};
+		break;
+	case TokenType::BANG:
+		compiledExpr = [right = std::move(right)](ClosureState& state) -> LoxValue { return !IsTruthy(right(state)); };
+		break;
+	default:
+		compiledExpr = [right = std::move(right)](ClosureState& state)
+		{
+			right(state);
+			return LoxValue();
+		};
+		break;
+	}
+}
+
+void ClosureCompiler::VisitVariableExpr(VariableExpr& expr)
+{
+	int slot = expr.slot;
+	if (expr.depth < 0)
+	{
+		compiledExpr = [name = expr.name](ClosureState& state) { return state.globals.Get(name); };
+	}
+	else if (expr.depth == 0)
+	{
+		compiledExpr = [slot](ClosureState& state) { return state.environment->GetAt(0, slot); };
+	}
+	else
+	{
+		compiledExpr = [depth = expr.depth, slot](ClosureState& state) { return state.environment->GetAt(depth, slot); };
+	}
+}
+
+void ClosureCompiler::VisitAssignExpr(AssignExpr& expr)
+{
+	ExprClosure value = Compile(*expr.value);
+	if (expr.depth < 0)
+	{
+		compiledExpr = [value = std::move(value), name = expr.name](ClosureState& state)
+		{
+			LoxValue result = value(state);
+			state.globals.Assign(name, result);
+			return result;
+		};
+		return;
+	}
+	compiledExpr = [value = std::move(value), depth = expr.depth, slot = expr.slot](ClosureState& state)
+	{
+		LoxValue result = value(state);
+		state.environment->AssignAt(depth, slot, result);
+		return result;
+	};
+}
+
+void ClosureCompiler::VisitLogicalExpr(LogicalExpr& expr)
+{
+	ExprClosure left = Compile(*expr.left);
+	ExprClosure right = Compile(*expr.right);
+	if (expr.op.type == TokenType::OR)
+	{
+		compiledExpr = [left = std::move(left), right = std::move(right)](ClosureState& state)
+		{
+			LoxValue value = left(state);
+			return IsTruthy(value) ? value : right(state);
+		};
+		return;
+	}
+	compiledExpr = [left = std::move(left), right = std::move(right)](ClosureState& state)
+	{
+		LoxValue value = left(state);
+		return IsTruthy(value) ? right(state) : value;
+	};
+}
+
+//the closures already specialise these shapes, so the tree they replaced is compiled
+void ClosureCompiler::VisitIncrementExpr(IncrementExpr& expr)
+{
+	compiledExpr = Compile(*expr.original);
+}
+
+void ClosureCompiler::VisitCompareExpr(CompareExpr& expr)
+{
+	compiledExpr = Compile(*expr.original);
+}
+
+//stmt visitor methods
+void ClosureCompiler::VisitExpressionStmt(ExpressionStmt& stmt)
+{
+	compiledStmt = [expression = Compile(*stmt.expression)](ClosureState& state) { expression(state); };
+}
+
+void ClosureCompiler::VisitPrintStmt(PrintStmt& stmt)
+{
+	compiledStmt = [expression = Compile(*stmt.expression), &output = output](ClosureState& state)
+	{
+		output.Print(expression(state));
+	};
+}
+
+void ClosureCompiler::VisitVarStmt(VarStmt& stmt)
+{
+	ExprClosure initializer;
+	if (stmt.initializer)
+	{
+		initializer = Compile(*stmt.initializer);
+	}
+	else
+	{
+		initializer = [](ClosureState&) { return LoxValue(); };
+	}
+
+	if (stmt.slot < 0)
+	{
+		compiledStmt = [initializer = std::move(initializer), name = stmt.name](ClosureState& state)
+		{
+			state.environment->Define(name, initializer(state));
+		};
+		return;
+	}
+	compiledStmt = [initializer = std::move(initializer), slot = stmt.slot](ClosureState& state)
+	{
+		state.environment->DefineAt(slot, initializer(state));
+	};
+}
+
+void ClosureCompiler::VisitBlockStmt(BlockStmt& stmt)
+{
+	//a block that declares no variables runs in the enclosing environment
+	if (stmt.slotCount == 0)
+	{
+		compiledStmt = [statements = Compile(stmt.statements)](ClosureState& state)
+		{
+			for (const auto& statement : statements)
+			{
+				statement(state);
+			}
+		};
+		return;
+	}
+
+	compiledStmt = [statements = Compile(stmt.statements), slotCount = stmt.slotCount](ClosureState& state)
+	{
+		auto previous = state.environment;
+		state.environment = state.frames.Push(previous, slotCount);
+		try
+		{
+			for (const auto& statement : statements)
+			{
+				statement(state);
+			}
+		}
+		catch (...)
+		{
+			state.frames.Pop();
+			state.environment = previous;
+			throw;
+		}
+		state.frames.Pop();
+		state.environment = previous;
+	};
+}
+
+void ClosureCompiler::VisitIfStmt(IfStmt& stmt)
+{
+	ExprClosure condition = Compile(*stmt.condition);
+	StmtClosure thenBranch = Compile(*stmt.thenBranch);
+	if (!stmt.elseBranch)
+	{
+		compiledStmt = [condition = std::move(condition), thenBranch = std::move(thenBranch)](ClosureState& state)
+		{
+			if (IsTruthy(condition(state))) thenBranch(state);
+		};
+		return;
+	}
+	compiledStmt = [condition = std::move(condition), thenBranch = std::move(thenBranch), elseBranch = Compile(*stmt.elseBranch)](ClosureState& state)
+	{
+		if (IsTruthy(condition(state))) thenBranch(state);
+		else elseBranch(state);
+	};
+}
+
+void ClosureCompiler::VisitWhileStmt(WhileStmt& stmt)
+{
+	compiledStmt = [condition = Compile(*stmt.condition), body = Compile(*stmt.body)](ClosureState& state)
+	{
+		while (IsTruthy(condition(state)))
+		{
+			body(state);
+		}
+	};
+}
+
+//helper methods
+ExprClosure ClosureCompiler::Compile(Expr& expr)
+{
+	expr.Accept(*this);
+	return std::move(compiledExpr);
+}
+
+StmtClosure ClosureCompiler::Compile(Stmt& stmt)
+{
+	stmt.Accept(*this);
+	return std::move(compiledStmt);
+}
+
+std::vector<StmtClosure> ClosureCompiler::Compile(const std::vector<StmtPtr>& statements)
+{
+	std::vector<StmtClosure> compiled;
+	compiled.reserve(statements.size());
+	for (const auto& statement : statements)
+	{
+		if (!statement) continue; //skipping null statements
+		compiled.push_back(Compile(*statement));
+	}
+	return compiled;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "Expr.h"
+#include "Stmt.h"
+#include "Environment.h"
+#include "OutputSink.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+//runtime state the compiled closures work on, same environment model as the Interpreter
+struct ClosureState
+{
+	Environment globals;
+	Environment* environment = &globals;
+	EnvironmentStack frames;
+};
+
+using ExprClosure = std::function<LoxValue(ClosureState&)>;
+using StmtClosure = std::function<void(ClosureState&)>;
+
+//third back end, between the treewalk interpreter and the vm. every node of the resolved AST
+//is turned once into a closure specialised for its operator, operand shape and variable kind,
+//so running the program never switches on a token type or visits a node again.
+class ClosureCompiler : public Expr::Visitor, public Stmt::Visitor
+{
+public:
+	explicit ClosureCompiler(OutputSink& output = StandardOutput()) : output(output) {}
+
+	//compiles and runs the statements. expects them to have been through the Resolver.
+	//false when a runtime error stopped them
+	bool Interpret(const std::vector<StmtPtr>& statements);
+
+	//expr visitor methods
+	void VisitBinaryExpr(BinaryExpr& expr) override;
+	void VisitGroupingExpr(GroupingExpr& expr) override;
+	void VisitLiteralExpr(LiteralExpr& expr) override;
+	void VisitUnaryExpr(UnaryExpr& expr) override;
+	void VisitVariableExpr(VariableExpr& expr) override;
+	void VisitAssignExpr(AssignExpr& expr) override;
+	void VisitLogicalExpr(LogicalExpr& expr) override;
+	void VisitIncrementExpr(IncrementExpr& expr) override;
+	void VisitCompareExpr(CompareExpr& expr) override;
+
+	//stmt visitor methods
+	void VisitExpressionStmt(ExpressionStmt& stmt) override;
+	void VisitPrintStmt(PrintStmt& stmt) override;
+	void VisitVarStmt(VarStmt& stmt) override;
+	void VisitBlockStmt(BlockStmt& stmt) override;
+	void VisitIfStmt(IfStmt& stmt) override;
+	void VisitWhileStmt(WhileStmt& stmt) override;
+
+private:
+	ExprClosure Compile(Expr& expr);
+	StmtClosure Compile(Stmt& stmt);
+	std::vector<StmtClosure> Compile(const std::vector<StmtPtr>& statements);
+
+	//result of the last visit
+	ExprClosure compiledExpr;
+	StmtClosure compiledStmt;
+
+	OutputSink& output;
+	//globals live on between REPL runs
+	ClosureState state;
+};
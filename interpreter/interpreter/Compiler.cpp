@@ -0,0 +1,379 @@
+#include "Compiler.h"
+#include "Lox.h"
+
+Chunk Compiler::Compile(const std::vector<StmtPtr>& statements)
+{
+	//the size of a forward jump is only known once the code it skips is compiled, and widening
+	//it then would move that code. a script with a jump that does not fit is compiled again
+	hadError = false;
+	longJumps = false;
+	CompileChunk(statements);
+	if (jumpTooLong && !hadError)
+	{
+		longJumps = true;
+		CompileChunk(statements);
+	}
+	return std::move(chunk);
+}
+
+void Compiler::CompileChunk(const std::vector<StmtPtr>& statements)
+{
+	chunk = Chunk();
+	locals.clear();
+	scopeDepth = 0;
+	line = 0;
+	jumpTooLong = false;
+	for (const auto& statement : statements)
+	{
+		if (!statement) continue; //skipping null statements
+		Compile(*statement);
+	}
+	Emit(OpCode::RETURN);
+}
+
+//expr visitor methods
+void Compiler::VisitBinaryExpr(BinaryExpr& expr)
+{
+	Compile(*expr.left);
+	Compile(*expr.right);
+
+	line = expr.op.line;
+	switch (expr.op.type)
+	{
+	case TokenType::PLUS: Emit(OpCode::ADD); break;
+	case TokenType::MINUS: Emit(OpCode::SUBTRACT); break;
+	case TokenType::STAR: Emit(OpCode::MULTIPLY); break;
+	case TokenType::SLASH: Emit(OpCode::DIVIDE); break;
+	case TokenType::GREATER: Emit(OpCode::GREATER); break;
+	case TokenType::GREATER_EQUAL: Emit(OpCode::GREATER_EQUAL); break;
+	case TokenType::LESS: Emit(OpCode::LESS); break;
+	case TokenType::LESS_EQUAL: Emit(OpCode::LESS_EQUAL); break;
+	case TokenType::BANG_EQUAL: Emit(OpCode::NOT_EQUAL); break;
+	case TokenType::EQUAL_EQUAL: Emit(OpCode::EQUAL); break;
+	default:
+		Error(expr.op, "Unknown binary operator.");
+	}
+}
+
+void Compiler::VisitGroupingExpr(GroupingExpr& expr)
+{
+	Compile(*expr.expression);
+}
+
+void Compiler::VisitLiteralExpr(LiteralExpr& expr)
+{
+	if (IsNil(expr.value)) Emit(OpCode::NIL);
+	else if (IsBool(expr.value)) Emit(AsBool(expr.value) ? OpCode::TRUE : OpCode::FALSE);
+	else EmitConstant(OpCode::CONSTANT, OpCode::CONSTANT_LONG, expr.value);
+}
+
+void Compiler::VisitUnaryExpr(UnaryExpr& expr)
+{
+	Compile(*expr.right);
+
+	line = expr.op.line;
+	switch (expr.op.type)
+	{
+	case TokenType::MINUS: Emit(OpCode::NEGATE); break;
+	case TokenType::BANG: Emit(OpCode::NOT); break;
+	default:
+		//the treewalk interpreter yields nil for unknown unary operators
+		Emit(OpCode::POP);
+		Emit(OpCode::NIL);
+		break;
+	}
+}
+
+void Compiler::VisitVariableExpr(VariableExpr& expr)
+{
+	line = expr.name.line;
+	int slot = ResolveLocal(expr.name);
+	if (slot >= 0)
+	{
+		Emit(OpCode::GET_LOCAL, static_cast<uint8_t>(slot));
+	}
+	else
+	{
+		EmitConstant(OpCode::GET_GLOBAL, OpCode::GET_GLOBAL_LONG, expr.name.lit);
+	}
+}
+
+void Compiler::VisitAssignExpr(AssignExpr& expr)
+{
+	Compile(*expr.value);
+
+	line = expr.name.line;
+	int slot = ResolveLocal(expr.name);
+	if (slot >= 0)
+	{
+		Emit(OpCode::SET_LOCAL, static_cast<uint8_t>(slot));
+	}
+	else
+	{
+		EmitConstant(OpCode::SET_GLOBAL, OpCode::SET_GLOBAL_LONG, expr.name.lit);
+	}
+}
+
+void Compiler::VisitLogicalExpr(LogicalExpr& expr)
+{
+	Compile(*expr.left);
+
+	line = expr.op.line;
+	if (expr.op.type == TokenType::OR)
+	{
+		//a truthy left operand is the result, otherwise fall through to the right
+		int elseJump = EmitJump(OpCode::JUMP_IF_FALSE);
+		int endJump = EmitJump(OpCode::JUMP);
+		PatchJump(elseJump);
+		Emit(OpCode::POP);
+		Compile(*expr.right);
+		PatchJump(endJump);
+	}
+	else
+	{
+		int endJump = EmitJump(OpCode::JUMP_IF_FALSE);
+		Emit(OpCode::POP);
+		Compile(*expr.right);
+		PatchJump(endJump);
+	}
+}
+
+//the vm has no superinstructions, it compiles the tree they replaced
+void Compiler::VisitIncrementExpr(IncrementExpr& expr)
+{
+	Compile(*expr.original);
+}
+
+void Compiler::VisitCompareExpr(CompareExpr& expr)
+{
+	Compile(*expr.original);
+}
+
+//stmt visitor methods
+void Compiler::VisitExpressionStmt(ExpressionStmt& stmt)
+{
+	Compile(*stmt.expression);
+	Emit(OpCode::POP);
+}
+
+void Compiler::VisitPrintStmt(PrintStmt& stmt)
+{
+	Compile(*stmt.expression);
+	Emit(OpCode::PRINT);
+}
+
+void Compiler::VisitVarStmt(VarStmt& stmt)
+{
+	//the initializer is compiled before the name is declared, so 'var a = a;'
+	//reads the enclosing 'a' just like the treewalk interpreter
+	if (stmt.initializer)
+	{
+		Compile(*stmt.initializer);
+	}
+	else
+	{
+		Emit(OpCode::NIL);
+	}
+
+	line = stmt.name.line;
+	if (scopeDepth == 0)
+	{
+		EmitConstant(OpCode::DEFINE_GLOBAL, OpCode::DEFINE_GLOBAL_LONG, stmt.name.lit);
+		return;
+	}
+
+	//redeclaring in the same block overwrites the existing slot
+	for (int i = static_cast<int>(locals.size()) - 1; i >= 0 && locals[i].depth == scopeDepth; --i)
+	{
+		if (locals[i].name == stmt.name.lexeme)
+		{
+			Emit(OpCode::SET_LOCAL, static_cast<uint8_t>(i));
+			Emit(OpCode::POP);
+			return;
+		}
+	}
+
+	if (locals.size() > UINT8_MAX)
+	{
+		Error(stmt.name, "Too many local variables in scope.");
+		return;
+	}
+	//the value left on the stack becomes the local's slot
+	locals.push_back({ stmt.name.lexeme, scopeDepth });
+}
+
+void Compiler::VisitBlockStmt(BlockStmt& stmt)
+{
+	scopeDepth++;
+	for (const auto& statement : stmt.statements)
+	{
+		if (!statement) continue; //skip null statements
+		Compile(*statement);
+	}
+	scopeDepth--;
+
+	//discard the block's locals
+	while (!locals.empty() && locals.back().depth > scopeDepth)
+	{
+		Emit(OpCode::POP);
+		locals.pop_back();
+	}
+}
+
+void Compiler::VisitIfStmt(IfStmt& stmt)
+{
+	Compile(*stmt.condition);
+
+	int thenJump = EmitJump(OpCode::JUMP_IF_FALSE);
+	Emit(OpCode::POP);
+	Compile(*stmt.thenBranch);
+
+	int elseJump = EmitJump(OpCode::JUMP);
+	PatchJump(thenJump);
+	Emit(OpCode::POP);
+	if (stmt.elseBranch)
+	{
+		Compile(*stmt.elseBranch);
+	}
+	PatchJump(elseJump);
+}
+
+void Compiler::VisitWhileStmt(WhileStmt& stmt)
+{
+	int loopStart = static_cast<int>(chunk.code.size());
+	Compile(*stmt.condition);
+
+	int exitJump = EmitJump(OpCode::JUMP_IF_FALSE);
+	Emit(OpCode::POP);
+	Compile(*stmt.body);
+	EmitLoop(loopStart);
+
+	PatchJump(exitJump);
+	Emit(OpCode::POP);
+}
+
+//some helper methods
+void Compiler::Compile(Expr& expr)
+{
+	expr.Accept(*this);
+}
+
+void Compiler::Compile(Stmt& stmt)
+{
+	stmt.Accept(*this);
+}
+
+void Compiler::Emit(OpCode op)
+{
+	chunk.Write(op, line);
+}
+
+void Compiler::Emit(OpCode op, uint8_t operand)
+{
+	chunk.Write(op, line);
+	chunk.Write(operand, line);
+}
+
+void Compiler::EmitShort(OpCode op, int operand)
+{
+	chunk.Write(op, line);
+	chunk.Write(static_cast<uint8_t>((operand >> 8) & 0xff), line);
+	chunk.Write(static_cast<uint8_t>(operand & 0xff), line);
+}
+
+void Compiler::EmitLong(OpCode op, int operand)
+{
+	chunk.Write(op, line);
+	chunk.Write(static_cast<uint8_t>((operand >> 16) & 0xff), line);
+	chunk.Write(static_cast<uint8_t>((operand >> 8) & 0xff), line);
+	chunk.Write(static_cast<uint8_t>(operand & 0xff), line);
+}
+
+void Compiler::EmitConstant(OpCode op, OpCode longOp, const LoxValue& value)
+{
+	int index = MakeConstant(value);
+	if (index > UINT16_MAX) EmitLong(longOp, index);
+	else EmitShort(op, index);
+}
+
+int Compiler::EmitJump(OpCode op)
+{
+	if (longJumps)
+	{
+		EmitLong(op == OpCode::JUMP ? OpCode::JUMP_LONG : OpCode::JUMP_IF_FALSE_LONG, 0xffffff);
+		return static_cast<int>(chunk.code.size()) - 3;
+	}
+	EmitShort(op, 0xffff);
+	return static_cast<int>(chunk.code.size()) - 2;
+}
+
+void Compiler::PatchJump(int offset)
+{
+	//jump distance is measured from the end of the operand
+	if (longJumps)
+	{
+		int jump = static_cast<int>(chunk.code.size()) - offset - 3;
+		if (jump > 0xffffff)
+		{
+			Error("Too much code to jump over.");
+		}
+		chunk.code[offset] = static_cast<uint8_t>((jump >> 16) & 0xff);
+		chunk.code[offset + 1] = static_cast<uint8_t>((jump >> 8) & 0xff);
+		chunk.code[offset + 2] = static_cast<uint8_t>(jump & 0xff);
+		return;
+	}
+	int jump = static_cast<int>(chunk.code.size()) - offset - 2;
+	//the chunk is compiled again with long jumps, this one is left as it is
+	if (jump > UINT16_MAX) jumpTooLong = true;
+	chunk.code[offset] = static_cast<uint8_t>((jump >> 8) & 0xff);
+	chunk.code[offset + 1] = static_cast<uint8_t>(jump & 0xff);
+}
+
+void Compiler::EmitLoop(int loopStart)
+{
+	//the distance back is known, so a loop only takes the long form when it needs it
+	int offset = static_cast<int>(chunk.code.size()) - loopStart + 3;
+	if (offset <= UINT16_MAX)
+	{
+		EmitShort(OpCode::LOOP, offset);
+		return;
+	}
+	offset += 1;
+	if (offset > 0xffffff)
+	{
+		Error("Loop body too large.");
+	}
+	EmitLong(OpCode::LOOP_LONG, offset);
+}
+
+int Compiler::MakeConstant(const LoxValue& value)
+{
+	int index = chunk.AddConstant(value);
+	if (index > 0xffffff)
+	{
+		Error("Too many constants in one chunk.");
+		return 0;
+	}
+	return index;
+}
+
+int Compiler::ResolveLocal(const Token& name) const
+{
+	for (int i = static_cast<int>(locals.size()) - 1; i >= 0; --i)
+	{
+		if (locals[i].name == name.lexeme) return i;
+	}
+	return -1;
+}
+
+void Compiler::Error(const Token& token, const std::string& message)
+{
+	hadError = true;
+	Lox::Error(token.line, message);
+}
+
+void Compiler::Error(const std::string& message)
+{
+	hadError = true;
+	Lox::Error(line, message);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "Expr.h"
+#include "Stmt.h"
+#include "Chunk.h"
+#include <vector>
+#include <memory>
+#include <string>
+
+//lowers the AST produced by the parser into a bytecode chunk for the vm.
+//top level variables become globals, variables declared in blocks live in stack slots.
+class Compiler : public Expr::Visitor, public Stmt::Visitor
+{
+public:
+	Chunk Compile(const std::vector<StmtPtr>& statements);
+
+	//expr visitor methods
+	void VisitBinaryExpr(BinaryExpr& expr) override;
+	void VisitGroupingExpr(GroupingExpr& expr) override;
+	void VisitLiteralExpr(LiteralExpr& expr) override;
+	void VisitUnaryExpr(UnaryExpr& expr) override;
+	void VisitVariableExpr(VariableExpr& expr) override;
+	void VisitAssignExpr(AssignExpr& expr) override;
+	void VisitLogicalExpr(LogicalExpr& expr) override;
+	void VisitIncrementExpr(IncrementExpr& expr) override;
+	void VisitCompareExpr(CompareExpr& expr) override;
+
+	//stmt visitor methods
+	void VisitExpressionStmt(ExpressionStmt& stmt) override;
+	void VisitPrintStmt(PrintStmt& stmt) override;
+	void VisitVarStmt(VarStmt& stmt) override;
+	void VisitBlockStmt(BlockStmt& stmt) override;
+	void VisitIfStmt(IfStmt& stmt) override;
+	void VisitWhileStmt(WhileStmt& stmt) override;
+
+private:
+	struct Local
+	{
+		std::string_view name;
+		int depth;
+	};
+
+	void Compile(Expr& expr);
+	void Compile(Stmt& stmt);
+
+	void Emit(OpCode op);
+	void Emit(OpCode op, uint8_t operand);
+	void EmitShort(OpCode op, int operand);
+	void EmitLong(OpCode op, int operand);
+	//the long form once the constant index no longer fits in 2 bytes
+	void EmitConstant(OpCode op, OpCode longOp, const LoxValue& value);
+	int EmitJump(OpCode op);
+	void PatchJump(int offset);
+	void EmitLoop(int loopStart);
+	int MakeConstant(const LoxValue& value);
+	void CompileChunk(const std::vector<StmtPtr>& statements);
+	//slot of the innermost local with this name, or -1 for a global
+	int ResolveLocal(const Token& name) const;
+	void Error(const Token& token, const std::string& message);
+	void Error(const std::string& message);
+
+	Chunk chunk;
+	std::vector<Local> locals;
+	int scopeDepth = 0;
+	int line = 0;
+	bool hadError = false;
+	//forward jumps take 3 byte offsets, set for the second try after one of them did not fit in 2
+	bool longJumps = false;
+	bool jumpTooLong = false;
+};
@@ -3,29 +3,44 @@
 #include <string>
 #include "Token.h"
 #include <unordered_map>
+#include <vector>
 #include "RuntimeError.h"
 
-
+//the global environment keeps variables in a map keyed by name. block environments are
+//created with a fixed number of slots and accessed by the (depth, slot) pairs from the Resolver.
 class Environment
 {
 	public:
 	Environment() = default;
-	//Environment(std::shared_ptr<Environment> parent = nullptr) : enclosing(parent) {}
-    explicit Environment(std::shared_ptr<Environment> enclosing) : enclosing(enclosing) {}
-	
+	Environment(const Environment&) = delete;
+	Environment& operator=(const Environment&) = delete;
+
+	//makes this a block environment again, keeping the slot storage it already has
+	void Reset(Environment* enclosing, size_t slotCount)
+	{
+		this->enclosing = enclosing;
+		slots.resize(slotCount);
+	}
 
-	void Define(const std::string& name, const LoxValue& value)
+	//drops the values of a block that has finished
+	void Clear()
 	{
-				values[name] = value;
+		slots.clear();
+	}
+
+	//globals are keyed by the interned name the scanner stores in identifier tokens
+	void Define(const Token& name, LoxValue value)
+	{
+				values[name.lit] = std::move(value);
 	
 	}
 
 	void Assign(const Token& name, const LoxValue& value)
 	{
-		auto iter = values.find(name.lexeme);
+		auto iter = values.find(name.lit);
 		if (iter != values.end())
 		{
-			values[name.lexeme] = value;
+			iter->second = value;
 			return;
 		}
 		if (enclosing != nullptr)
@@ -34,12 +49,12 @@ class Environment
 			return;
 		}
 
-		throw RuntimeError(name, "undefined variable '" + name.lexeme + "'.");
+		throw RuntimeError(name, "undefined variable '" + std::string(name.lexeme) + "'.");
 	}
 
 	LoxValue Get(const Token& name)
 	{
-		auto iter = values.find(name.lexeme);
+		auto iter = values.find(name.lit);
 		if (iter != values.end())
 		{
 			return iter->second;
@@ -49,11 +64,71 @@ class Environment
 			return enclosing->Get(name);
 		}
 
-		throw RuntimeError(name, "undefined variable '" + name.lexeme + "'.");
+		throw RuntimeError(name, "undefined variable '" + std::string(name.lexeme) + "'.");
+	}
+
+	//slot based access for resolved local variables
+	void DefineAt(int slot, LoxValue value)
+	{
+		slots[slot] = std::move(value);
+	}
+
+	void AssignAt(int depth, int slot, const LoxValue& value)
+	{
+		Ancestor(depth)->slots[slot] = value;
+	}
+
+	const LoxValue& GetAt(int depth, int slot)
+	{
+		return Ancestor(depth)->slots[slot];
+	}
+
+	//for updating a slot in place
+	LoxValue& At(int depth, int slot)
+	{
+		return Ancestor(depth)->slots[slot];
 	}
 
 private:
+	Environment* Ancestor(int depth)
+	{
+		Environment* environment = this;
+		for (int i = 0; i < depth; ++i)
+		{
+			environment = environment->enclosing;
+		}
+		return environment;
+	}
+
 	//keep a map of all variables and their values
-	std::unordered_map<std::string, LoxValue> values;
-	std::shared_ptr<Environment> enclosing;
+	std::unordered_map<LoxValue, LoxValue, LoxValueHash, LoxValueEqual> values;
+	std::vector<LoxValue> slots;
+	Environment* enclosing = nullptr;
+};
+
+//block environments never outlive the block that made them, so they are handed out in
+//stack order from here and reused. after the first few iterations of a loop, entering its
+//body allocates nothing.
+class EnvironmentStack
+{
+public:
+	Environment* Push(Environment* enclosing, size_t slotCount)
+	{
+		if (used == frames.size())
+		{
+			frames.push_back(std::make_unique<Environment>());
+		}
+		Environment* environment = frames[used++].get();
+		environment->Reset(enclosing, slotCount);
+		return environment;
+	}
+
+	void Pop()
+	{
+		frames[--used]->Clear();
+	}
+
+private:
+	std::vector<std::unique_ptr<Environment>> frames;
+	size_t used = 0;
 };
\ No newline at end of file
@@ -1,51 +1,83 @@
 #pragma once
 #include <memory>
 #include "Token.h"
+#include "Arena.h"
 
 //expressions for the AST. base class for all nodes, then derived classes for each type of expression.
-//every node represented as unique_ptr.
+//every node is allocated in the parse Arena and owned through an ExprPtr.
+
+class BinaryExpr;
+class GroupingExpr;
+class LiteralExpr;
+class UnaryExpr;
+class VariableExpr;
+class AssignExpr;
+class LogicalExpr;
+class IncrementExpr;
+class CompareExpr;
+
+//R is what a visit returns. void for passes that only walk or rewrite the tree, LoxValue for
+//the interpreter, which hands each result straight back to its parent without a side channel.
+template <typename R>
+struct ExprVisitor
+{
+	virtual R VisitBinaryExpr(BinaryExpr& expr) = 0;
+	virtual R VisitGroupingExpr(GroupingExpr& expr) = 0;
+	virtual R VisitLiteralExpr(LiteralExpr& expr) = 0;
+	virtual R VisitUnaryExpr(UnaryExpr& expr) = 0;
+	virtual R VisitVariableExpr(VariableExpr& expr) = 0;
+	virtual R VisitAssignExpr(AssignExpr& expr) = 0;
+	virtual R VisitLogicalExpr(LogicalExpr& expr) = 0;
+	virtual R VisitIncrementExpr(IncrementExpr& expr) = 0;
+	virtual R VisitCompareExpr(CompareExpr& expr) = 0;
+};
 
 class Expr
 {
 public:
-	struct Visitor;
+	using Visitor = ExprVisitor<void>;
+	using ValueVisitor = ExprVisitor<LoxValue>;
 	virtual ~Expr() = default;
 	virtual void Accept(Visitor& visitor) = 0;
+	virtual LoxValue Accept(ValueVisitor& visitor) = 0;
 };
 
-struct Expr::Visitor
+using ExprPtr = ArenaPtr<Expr>;
+
+//operand types the Interpreter has seen at a BinaryExpr. a node that only ever sees numbers is
+//quickened to the number-only operators, the first other operand sends it back to the generic path for good.
+enum class OperandFeedback : uint8_t
 {
-	virtual void VisitBinaryExpr(class BinaryExpr& expr) = 0;
-	virtual void VisitGroupingExpr(class GroupingExpr& expr) = 0;
-	virtual void VisitLiteralExpr(class LiteralExpr& expr) = 0;
-	virtual void VisitUnaryExpr(class UnaryExpr& expr) = 0;
-	virtual void VisitVariableExpr(class VariableExpr& expr) = 0;
-	virtual void VisitAssignExpr(class AssignExpr& expr) = 0;
-	virtual void VisitLogicalExpr(class LogicalExpr& expr) = 0;
+	Unseen,
+	Numbers,
+	Generic
 };
 
 class BinaryExpr : public Expr
 {
 public:
-	std::unique_ptr<Expr> left;
+	ExprPtr left;
 	Token op;
-	std::unique_ptr<Expr> right;
+	ExprPtr right;
+	OperandFeedback feedback = OperandFeedback::Unseen;
 
-	BinaryExpr(std::unique_ptr<Expr> left, Token op, std::unique_ptr<Expr> right)
+	BinaryExpr(ExprPtr left, Token op, ExprPtr right)
 		: left(std::move(left)), op(op), right(std::move(right)) {}
 
 	void Accept(Visitor& visitor) override { visitor.VisitBinaryExpr(*this); }
+	LoxValue Accept(ValueVisitor& visitor) override { return visitor.VisitBinaryExpr(*this); }
 };
 
 class GroupingExpr : public Expr
 {
 public:
-	std::unique_ptr<Expr> expression;
+	ExprPtr expression;
 
-	GroupingExpr(std::unique_ptr<Expr> expression)
+	GroupingExpr(ExprPtr expression)
 		: expression(std::move(expression)) {}
 
 	void Accept(Visitor& visitor) override { visitor.VisitGroupingExpr(*this); }
+	LoxValue Accept(ValueVisitor& visitor) override { return visitor.VisitGroupingExpr(*this); }
 };
 
 class LiteralExpr : public Expr {
@@ -58,47 +90,93 @@ public:
 	void Accept(Visitor& visitor) override {
 		visitor.VisitLiteralExpr(*this);
 	}
+	LoxValue Accept(ValueVisitor& visitor) override { return visitor.VisitLiteralExpr(*this); }
 };
 
 class UnaryExpr : public Expr {
 public:
 	Token op;
-	std::unique_ptr<Expr> right;
+	ExprPtr right;
 
-	UnaryExpr(Token op, std::unique_ptr<Expr> right)
+	UnaryExpr(Token op, ExprPtr right)
 		: op(op), right(std::move(right)) {}
 
 	void Accept(Visitor& visitor) override {
 		visitor.VisitUnaryExpr(*this);
 	}
+	LoxValue Accept(ValueVisitor& visitor) override { return visitor.VisitUnaryExpr(*this); }
 };
 
 class VariableExpr : public Expr
 {
 public:
 	Token name;
+	//filled in by the Resolver: environments to walk up and the slot there. depth -1 means global
+	int depth = -1;
+	int slot = -1;
 	VariableExpr(Token name) : name(name) {};
 	void Accept(Visitor& visitor) override { visitor.VisitVariableExpr(*this); }
+	LoxValue Accept(ValueVisitor& visitor) override { return visitor.VisitVariableExpr(*this); }
 };
 
 class AssignExpr : public Expr
 {
 public:
 	Token name;
-	std::unique_ptr<Expr> value;
-	AssignExpr(Token name, std::unique_ptr<Expr> value) : name(name), value(std::move(value)) {};
+	ExprPtr value;
+	int depth = -1;
+	int slot = -1;
+	AssignExpr(Token name, ExprPtr value) : name(name), value(std::move(value)) {};
 	void Accept(Visitor& visitor) override { visitor.VisitAssignExpr(*this); };
+	LoxValue Accept(ValueVisitor& visitor) override { return visitor.VisitAssignExpr(*this); }
 };
 
 class LogicalExpr : public Expr
 {
 public:
-	std::unique_ptr<Expr> left;
+	ExprPtr left;
 	Token op;
-	std::unique_ptr<Expr> right;
+	ExprPtr right;
 
-	LogicalExpr(std::unique_ptr<Expr> left, Token op, std::unique_ptr<Expr> right)
+	LogicalExpr(ExprPtr left, Token op, ExprPtr right)
 		: left(std::move(left)), op(op), right(std::move(right)) {}
 
 	void Accept(Visitor& visitor) override { visitor.VisitLogicalExpr(*this); }
+	LoxValue Accept(ValueVisitor& visitor) override { return visitor.VisitLogicalExpr(*this); }
+};
+
+//superinstructions made by the Fuser from common loop shapes. each one keeps the tree it replaced
+//in original, a back end without a fast path for it, or a fast path whose guard fails, visits that.
+
+//local = local + number, or local - number, on the same local
+class IncrementExpr : public Expr
+{
+public:
+	ExprPtr original; //the AssignExpr
+	int depth;
+	int slot;
+	double amount; //negated for -
+
+	IncrementExpr(ExprPtr original, int depth, int slot, double amount)
+		: original(std::move(original)), depth(depth), slot(slot), amount(amount) {}
+
+	void Accept(Visitor& visitor) override { visitor.VisitIncrementExpr(*this); }
+	LoxValue Accept(ValueVisitor& visitor) override { return visitor.VisitIncrementExpr(*this); }
+};
+
+//local < local or local < number, and the same for <=, > and >=
+class CompareExpr : public Expr
+{
+public:
+	ExprPtr original; //the BinaryExpr
+	TokenType op;
+	const VariableExpr& left;
+	const VariableExpr* right; //null when comparing with the constant
+	double constant;
+
+	CompareExpr(ExprPtr original, TokenType op, const VariableExpr& left, const VariableExpr* right, double constant)
+		: original(std::move(original)), op(op), left(left), right(right), constant(constant) {}
+
+	void Accept(Visitor& visitor) override { visitor.VisitCompareExpr(*this); }
+	LoxValue Accept(ValueVisitor& visitor) override { return visitor.VisitCompareExpr(*this); }
 };
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "Fuser.h"
+
+static const VariableExpr* AsLocal(const Expr& expr)
+{
+	auto variable = dynamic_cast<const VariableExpr*>(&expr);
+	return variable && variable->depth >= 0 ? variable : nullptr;
+}
+
+static const LiteralExpr* AsNumber(const Expr& expr)
+{
+	auto literal = dynamic_cast<const LiteralExpr*>(&expr);
+	return literal && IsNumber(literal->value) ? literal : nullptr;
+}
+
+void Fuser::Fuse(std::vector<StmtPtr>& statements)
+{
+	for (auto& statement : statements)
+	{
+		if (!statement) continue; //skipping null statements
+		Fuse(*statement);
+	}
+}
+
+//expr visitor methods
+void Fuser::VisitBinaryExpr(BinaryExpr& expr)
+{
+	Fuse(expr.left);
+	Fuse(expr.right);
+
+	switch (expr.op.type)
+	{
+	case TokenType::LESS:
+	case TokenType::LESS_EQUAL:
+	case TokenType::GREATER:
+	case TokenType::GREATER_EQUAL:
+		break;
+	default:
+		return;
+	}
+
+	const VariableExpr* left = AsLocal(*expr.left);
+	if (!left) return;
+	const VariableExpr* right = AsLocal(*expr.right);
+	const LiteralExpr* constant = right ? nullptr : AsNumber(*expr.right);
+	if (!right && !constant) return;
+
+	Replace<CompareExpr>(expr.op.type, *left, right, constant ? ::AsNumber(constant->value) : 0.0);
+}
+
+void Fuser::VisitGroupingExpr(GroupingExpr& expr)
+{
+	Fuse(expr.expression);
+}
+
+void Fuser::VisitLiteralExpr(LiteralExpr&)
+{
+}
+
+void Fuser::VisitUnaryExpr(UnaryExpr& expr)
+{
+	Fuse(expr.right);
+}
+
+void Fuser::VisitVariableExpr(VariableExpr&)
+{
+}
+
+void Fuser::VisitAssignExpr(AssignExpr& expr)
+{
+	//checked before visiting the value, which would fuse nothing in this shape anyway
+	auto sum = dynamic_cast<BinaryExpr*>(expr.value.get());
+	if (expr.depth >= 0 && sum && (sum->op.type == TokenType::PLUS || sum->op.type == TokenType::MINUS))
+	{
+		const VariableExpr* variable = AsLocal(*sum->left);
+		const LiteralExpr* constant = AsNumber(*sum->right);
+		if (variable && constant && variable->depth == expr.depth && variable->slot == expr.slot)
+		{
+			double amount = ::AsNumber(constant->value);
+			Replace<IncrementExpr>(expr.depth, expr.slot, sum->op.type == TokenType::PLUS ? amount : -amount);
+			return;
+		}
+	}
+	Fuse(expr.value);
+}
+
+void Fuser::VisitLogicalExpr(LogicalExpr& expr)
+{
+	Fuse(expr.left);
+	Fuse(expr.right);
+}
+
+void Fuser::VisitIncrementExpr(IncrementExpr&)
+{
+}
+
+void Fuser::VisitCompareExpr(CompareExpr&)
+{
+}
+
+//stmt visitor methods
+void Fuser::VisitExpressionStmt(ExpressionStmt& stmt)
+{
+	Fuse(stmt.expression);
+}
+
+void Fuser::VisitPrintStmt(PrintStmt& stmt)
+{
+	Fuse(stmt.expression);
+}
+
+void Fuser::VisitVarStmt(VarStmt& stmt)
+{
+	if (stmt.initializer) Fuse(stmt.initializer);
+}
+
+void Fuser::VisitBlockStmt(BlockStmt& stmt)
+{
+	Fuse(stmt.statements);
+}
+
+void Fuser::VisitIfStmt(IfStmt& stmt)
+{
+	Fuse(stmt.condition);
+	stmt.compare = dynamic_cast<CompareExpr*>(stmt.condition.get());
+	Fuse(*stmt.thenBranch);
+	if (stmt.elseBranch) Fuse(*stmt.elseBranch);
+}
+
+void Fuser::VisitWhileStmt(WhileStmt& stmt)
+{
+	Fuse(stmt.condition);
+	stmt.compare = dynamic_cast<CompareExpr*>(stmt.condition.get());
+	Fuse(*stmt.body);
+}
+
+//helper methods
+void Fuser::Fuse(ExprPtr& expr)
+{
+	expr->Accept(*this);
+	if (replacement)
+	{
+		//the superinstruction takes over the node it replaces
+		*replacementOriginal = std::move(expr);
+		expr = std::move(replacement);
+	}
+}
+
+void Fuser::Fuse(Stmt& stmt)
+{
+	stmt.Accept(*this);
+}
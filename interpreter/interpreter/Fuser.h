@@ -0,0 +1,55 @@
+#pragma once
+#include "Expr.h"
+#include "Stmt.h"
+#include "Arena.h"
+#include <utility>
+#include <vector>
+
+//last pass before execution. recognises the shapes that dominate counting loops and replaces them
+//with superinstructions (see IncrementExpr and CompareExpr), so the Interpreter runs
+//while (i < n) { ... i = i + 1; } without visiting the variable and literal nodes every iteration.
+//only resolved locals are fused, globals still go through the map lookup.
+class Fuser : public Expr::Visitor, public Stmt::Visitor
+{
+public:
+	explicit Fuser(Arena& arena) : arena(arena) {}
+
+	void Fuse(std::vector<StmtPtr>& statements);
+
+	//expr visitor methods
+	void VisitBinaryExpr(BinaryExpr& expr) override;
+	void VisitGroupingExpr(GroupingExpr& expr) override;
+	void VisitLiteralExpr(LiteralExpr& expr) override;
+	void VisitUnaryExpr(UnaryExpr& expr) override;
+	void VisitVariableExpr(VariableExpr& expr) override;
+	void VisitAssignExpr(AssignExpr& expr) override;
+	void VisitLogicalExpr(LogicalExpr& expr) override;
+	void VisitIncrementExpr(IncrementExpr& expr) override;
+	void VisitCompareExpr(CompareExpr& expr) override;
+
+	//stmt visitor methods
+	void VisitExpressionStmt(ExpressionStmt& stmt) override;
+	void VisitPrintStmt(PrintStmt& stmt) override;
+	void VisitVarStmt(VarStmt& stmt) override;
+	void VisitBlockStmt(BlockStmt& stmt) override;
+	void VisitIfStmt(IfStmt& stmt) override;
+	void VisitWhileStmt(WhileStmt& stmt) override;
+
+private:
+	//visit the node and swap in the superinstruction, if the visitor made one
+	void Fuse(ExprPtr& expr);
+	void Fuse(Stmt& stmt);
+
+	//makes the superinstruction for the node being visited, Fuse hands it that node afterwards
+	template <typename T, typename... Args>
+	void Replace(Args&&... args)
+	{
+		auto node = arena.Make<T>(ExprPtr(), std::forward<Args>(args)...);
+		replacementOriginal = &node->original;
+		replacement = std::move(node);
+	}
+
+	Arena& arena;
+	ExprPtr replacement;
+	ExprPtr* replacementOriginal = nullptr;
+};
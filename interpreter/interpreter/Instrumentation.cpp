@@ -0,0 +1,135 @@
+#include "Instrumentation.h"
+#include "LineFinder.h"
+#include <algorithm>
+#include <iomanip>
+
+namespace
+{
+	//walks the whole tree, including the trees kept by superinstructions, and adds the counts of
+	//every node to its line. a node without a token of its own, like a literal, counts for the
+	//line of the node around it
+	class LineCollector : public Expr::Visitor, public Stmt::Visitor
+	{
+	public:
+		LineCollector(const std::unordered_map<const void*, ExecutionCount>& nodes, std::map<int, ExecutionCount>& lines)
+			: nodes(nodes), lines(lines) {}
+
+		void Collect(Expr& expr)
+		{
+			int outer = line;
+			if (int first = FirstLine(expr)) line = first;
+			Add(&expr);
+			expr.Accept(*this);
+			line = outer;
+		}
+
+		void Collect(Stmt* stmt)
+		{
+			if (!stmt) return;
+			int outer = line;
+			if (int first = FirstLine(*stmt)) line = first;
+			Add(stmt);
+			stmt->Accept(*this);
+			line = outer;
+		}
+
+		//expr visitor methods
+		void VisitBinaryExpr(BinaryExpr& expr) override
+		{
+			Collect(*expr.left);
+			Collect(*expr.right);
+		}
+		void VisitGroupingExpr(GroupingExpr& expr) override { Collect(*expr.expression); }
+		void VisitLiteralExpr(LiteralExpr&) override {}
+		void VisitUnaryExpr(UnaryExpr& expr) override { Collect(*expr.right); }
+		void VisitVariableExpr(VariableExpr&) override {}
+		void VisitAssignExpr(AssignExpr& expr) override { Collect(*expr.value); }
+		void VisitLogicalExpr(LogicalExpr& expr) override
+		{
+			Collect(*expr.left);
+			Collect(*expr.right);
+		}
+		void VisitIncrementExpr(IncrementExpr& expr) override { Collect(*expr.original); }
+		void VisitCompareExpr(CompareExpr& expr) override { Collect(*expr.original); }
+
+		//stmt visitor methods
+		void VisitExpressionStmt(ExpressionStmt& stmt) override { Collect(*stmt.expression); }
+		void VisitPrintStmt(PrintStmt& stmt) override { Collect(*stmt.expression); }
+		void VisitVarStmt(VarStmt& stmt) override
+		{
+			if (stmt.initializer) Collect(*stmt.initializer);
+		}
+		void VisitBlockStmt(BlockStmt& stmt) override
+		{
+			for (const auto& statement : stmt.statements) Collect(statement.get());
+		}
+		void VisitIfStmt(IfStmt& stmt) override
+		{
+			Collect(*stmt.condition);
+			Collect(stmt.thenBranch.get());
+			Collect(stmt.elseBranch.get());
+		}
+		void VisitWhileStmt(WhileStmt& stmt) override
+		{
+			Collect(*stmt.condition);
+			Collect(stmt.body.get());
+		}
+
+	private:
+		void Add(const void* node)
+		{
+			auto found = nodes.find(node);
+			if (found == nodes.end()) return;
+			ExecutionCount& counts = lines[line];
+			counts.count = std::max(counts.count, found->second.count);
+			counts.selfNanoseconds += found->second.selfNanoseconds;
+		}
+
+		const std::unordered_map<const void*, ExecutionCount>& nodes;
+		std::map<int, ExecutionCount>& lines;
+		int line = 0;
+	};
+}
+
+void ExecutionCounters::Finish(const std::vector<StmtPtr>& statements)
+{
+	LineCollector collector(nodes, lines);
+	for (const auto& statement : statements) collector.Collect(statement.get());
+	//the nodes are about to go away with their arena
+	nodes.clear();
+	running.clear();
+}
+
+void ExecutionCounters::Report(std::ostream& out, std::string_view source) const
+{
+	out << "   line        count";
+	if (timed) out << "    self ms";
+	out << "  code\n";
+
+	//lines come out in order, so the source is walked once
+	int current = 1;
+	size_t start = 0;
+	for (const auto& [number, counts] : lines)
+	{
+		while (current < number && start < source.size())
+		{
+			size_t newline = source.find('\n', start);
+			start = newline == std::string_view::npos ? source.size() : newline + 1;
+			++current;
+		}
+		std::string_view code;
+		if (number >= 1 && current == number)
+		{
+			size_t end = std::min(source.find('\n', start), source.size());
+			code = source.substr(start, end - start);
+			if (!code.empty() && code.back() == '\r') code.remove_suffix(1);
+		}
+
+		out << std::setw(7);
+		if (number == 0) out << "?";
+		else out << number;
+		out << std::setw(13) << counts.count;
+		if (timed) out << std::fixed << std::setprecision(3) << std::setw(11) << counts.selfNanoseconds / 1e6 << std::defaultfloat;
+		out << "  " << code << "\n";
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "Expr.h"
+#include "Stmt.h"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+//instrumentation policies for BasicInterpreter. the interpreter opens a Scope of its policy around
+//every expression it evaluates and every statement it executes, and hands the program to Finish
+//once it has run.
+
+//the default, its scopes are empty and compile away
+struct NoInstrumentation
+{
+	struct Scope
+	{
+		Scope(NoInstrumentation&, const Expr&) {}
+		Scope(NoInstrumentation&, const Stmt&) {}
+	};
+
+	void Finish(const std::vector<StmtPtr>&) {}
+};
+
+//what ExecutionCounters records for a node, and adds up for a line
+struct ExecutionCount
+{
+	uint64_t count = 0;
+	uint64_t selfNanoseconds = 0;
+};
+
+//exact execution count of every node, for --instrument. when timed, also the time spent in each
+//node itself, not counting the nodes it evaluated; the clock reads of those children still land
+//in it. Finish adds the nodes up per source line while the tree is alive, the count of a line is
+//that of its most executed node.
+class ExecutionCounters
+{
+public:
+	class Scope
+	{
+	public:
+		Scope(ExecutionCounters& counters, const Expr& expr) : counters(counters) { counters.Enter(&expr); }
+		Scope(ExecutionCounters& counters, const Stmt& stmt) : counters(counters) { counters.Enter(&stmt); }
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		~Scope() { counters.Leave(); }
+
+	private:
+		ExecutionCounters& counters;
+	};
+
+	void SetTimed(bool timed) { this->timed = timed; }
+
+	void Finish(const std::vector<StmtPtr>& statements);
+	//the source lines that ran, with their counts and self time
+	void Report(std::ostream& out, std::string_view source) const;
+
+private:
+	void Enter(const void* node)
+	{
+		ExecutionCount& counts = nodes[node];
+		++counts.count;
+		if (timed) running.push_back({ &counts, std::chrono::steady_clock::now(), 0 });
+	}
+
+	void Leave()
+	{
+		if (!timed) return;
+		Running node = running.back();
+		running.pop_back();
+		uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - node.start).count();
+		node.counts->selfNanoseconds += elapsed - node.childNanoseconds;
+		if (!running.empty()) running.back().childNanoseconds += elapsed;
+	}
+
+	//a node that has been entered and not left yet
+	struct Running
+	{
+		ExecutionCount* counts;
+		std::chrono::steady_clock::time_point start;
+		uint64_t childNanoseconds;
+	};
+
+	bool timed = false;
+	std::unordered_map<const void*, ExecutionCount> nodes;
+	std::vector<Running> running;
+	std::map<int, ExecutionCount> lines;
+};
@@ -4,8 +4,11 @@
 #include "Environment.h"
 
 
-void Interpreter::Interpret(const std::vector<std::unique_ptr<Stmt>>& statements)
+template <typename Instrumentation>
+bool BasicInterpreter<Instrumentation>::Interpret(const std::vector<StmtPtr>& statements)
 {
+	if (profiler) profiler->Start();
+	bool completed = true;
 	try
 	{
 		for (const auto& statement : statements)
@@ -16,167 +19,221 @@ void Interpreter::Interpret(const std::vector<std::unique_ptr<Stmt>>& statements
 	}
 	catch (const RuntimeError& error)
 	{
+		output.Flush();
 		std::cerr << "[line " << error.getToken().line << "] RuntimeError: "
 			<< error.what() << "\n";
+		if (profiler) profiler->Unwind();
+		completed = false;
+	}
+	if (profiler) profiler->Stop();
+	instrumentation.Finish(statements);
+	return completed;
+}
+
+//the operators on two numbers, for a BinaryExpr quickened by its type feedback
+static LoxValue NumberBinary(const Token& op, double left, double right)
+{
+	switch (op.type)
+	{
+	case TokenType::PLUS: return left + right;
+	case TokenType::MINUS: return left - right;
+	case TokenType::STAR: return left * right;
+	case TokenType::SLASH:
+		if (right == 0) throw RuntimeError(op, "Division by zero.");
+		return left / right;
+	case TokenType::GREATER: return left > right;
+	case TokenType::GREATER_EQUAL: return left >= right;
+	case TokenType::LESS: return left < right;
+	case TokenType::LESS_EQUAL: return left <= right;
+	case TokenType::EQUAL_EQUAL: return left == right;
+	case TokenType::BANG_EQUAL: return left != right;
+	default: throw RuntimeError(op, "Unknown binary operator.");
 	}
 }
 
 //expr visitor methods
-void Interpreter::VisitBinaryExpr(BinaryExpr& expr)
+template <typename Instrumentation>
+LoxValue BasicInterpreter<Instrumentation>::VisitBinaryExpr(BinaryExpr& expr)
 {
 	auto left = Evaluate(*expr.left);
 	auto right = Evaluate(*expr.right);
 
+	//one guard on the quickened path, a type change deoptimises the node
+	if (expr.feedback == OperandFeedback::Numbers)
+	{
+		if (IsNumber(left) && IsNumber(right))
+		{
+			++cacheStats.hits;
+			return NumberBinary(expr.op, AsNumber(left), AsNumber(right));
+		}
+		++cacheStats.misses;
+		expr.feedback = OperandFeedback::Generic;
+	}
+	else if (expr.feedback == OperandFeedback::Unseen)
+	{
+		expr.feedback = IsNumber(left) && IsNumber(right) ? OperandFeedback::Numbers : OperandFeedback::Generic;
+	}
+	++cacheStats.generic;
+	return GenericBinary(expr, left, right);
+}
+
+template <typename Instrumentation>
+LoxValue BasicInterpreter<Instrumentation>::GenericBinary(BinaryExpr& expr, const LoxValue& left, const LoxValue& right)
+{
 	switch (expr.op.type)
 	{
 	case TokenType::PLUS:
-		if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
+		if (IsNumber(left) && IsNumber(right))
 		{
-			lastValue = std::get<double>(left) + std::get<double>(right);
+			return AsNumber(left) + AsNumber(right);
 		}
-		else if (std::holds_alternative<std::string>(left) && std::holds_alternative<std::string>(right))
+		else if (IsString(left) && IsString(right))
 		{
-			lastValue = std::get<std::string>(left) + std::get<std::string>(right);
+			return Concatenate(left, right);
 		}
 		else
 		{
 			throw RuntimeError(expr.op, "Operands must be two numbers or two strings.");
 		}
-		break;
 	case TokenType::MINUS:
-		if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
+		if (IsNumber(left) && IsNumber(right))
 		{
-			lastValue = std::get<double>(left) - std::get<double>(right);
+			return AsNumber(left) - AsNumber(right);
 		}
 		else
 		{
 			throw RuntimeError(expr.op, "Operands must be numbers.");
 		}
-		break;
 	case TokenType::STAR:
-		if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
+		if (IsNumber(left) && IsNumber(right))
 		{
-			lastValue = std::get<double>(left) * std::get<double>(right);
+			return AsNumber(left) * AsNumber(right);
 		}
 		else
 		{
 			throw RuntimeError(expr.op, "Operands must be numbers.");
 		}
-		break;
 	case TokenType::SLASH:
-		if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
+		if (IsNumber(left) && IsNumber(right))
 		{
-			if (std::get<double>(right) == 0)
+			if (AsNumber(right) == 0)
 			{
 				throw RuntimeError(expr.op, "Division by zero.");
 			}
-			lastValue = std::get<double>(left) / std::get<double>(right);
+			return AsNumber(left) / AsNumber(right);
 		}
 		else
 		{
 			throw RuntimeError(expr.op, "Operands must be numbers.");
 		}
-		break;
 	case TokenType::GREATER:
-		if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
+		if (IsNumber(left) && IsNumber(right))
 		{
-			lastValue = std::get<double>(left) > std::get<double>(right);
+			return AsNumber(left) > AsNumber(right);
 		}
 		else
 		{
-			throw std::exception("Operands must be numbers.");
+			throw RuntimeError(expr.op, "Operands must be numbers.");
 		}
-		break;
 	case TokenType::GREATER_EQUAL:
-		if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
+		if (IsNumber(left) && IsNumber(right))
 		{
-			lastValue = std::get<double>(left) >= std::get<double>(right);
+			return AsNumber(left) >= AsNumber(right);
 		}
 		else
 		{
-			throw std::exception("Operands must be numbers.");
+			throw RuntimeError(expr.op, "Operands must be numbers.");
 		}
-		break;
 	case TokenType::LESS:
-		if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
+		if (IsNumber(left) && IsNumber(right))
 		{
-			lastValue = std::get<double>(left) < std::get<double>(right);
+			return AsNumber(left) < AsNumber(right);
 		}
 		else
 		{
-			throw std::exception("Operands must be numbers.");
+			throw RuntimeError(expr.op, "Operands must be numbers.");
 		}
-		break;
 	case TokenType::LESS_EQUAL:
-		if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right))
+		if (IsNumber(left) && IsNumber(right))
 		{
-			lastValue = std::get<double>(left) <= std::get<double>(right);
+			return AsNumber(left) <= AsNumber(right);
 		}
 		else
 		{
-			throw std::exception("Operands must be numbers.");
+			throw RuntimeError(expr.op, "Operands must be numbers.");
 		}
-		break;
 	case TokenType::BANG_EQUAL:
-		lastValue = !IsEqual(left, right);
-		break;
+		return !IsEqual(left, right);
 	case TokenType::EQUAL_EQUAL:
-		lastValue = IsEqual(left, right);
-		break;
+		return IsEqual(left, right);
 	default:
 		throw RuntimeError(expr.op, "Unknown binary operator.");
 	}
 
 }
 
-void Interpreter::VisitGroupingExpr(GroupingExpr& expr)
+template <typename Instrumentation>
+LoxValue BasicInterpreter<Instrumentation>::VisitGroupingExpr(GroupingExpr& expr)
 {
-	lastValue = Evaluate(*expr.expression);
+	return Evaluate(*expr.expression);
 }
 
-void Interpreter::VisitLiteralExpr(LiteralExpr& expr)
+template <typename Instrumentation>
+LoxValue BasicInterpreter<Instrumentation>::VisitLiteralExpr(LiteralExpr& expr)
 {
-	lastValue = expr.value;
+	return expr.value;
 }
 
-void Interpreter::VisitUnaryExpr(UnaryExpr& expr)
+template <typename Instrumentation>
+LoxValue BasicInterpreter<Instrumentation>::VisitUnaryExpr(UnaryExpr& expr)
 {
 	auto right = Evaluate(*expr.right);
 
 	switch (expr.op.type)
 	{
 	case TokenType::MINUS:
-		if (std::holds_alternative<double>(right))
+		if (IsNumber(right))
 		{
-			lastValue = -std::get<double>(right);
+			return -AsNumber(right);
 		}
 		else
 		{
 			throw RuntimeError(expr.op, "Operand must be a number.");
 		}
-		break;
 	case TokenType::BANG:
-		lastValue = !IsTruthy(right);
-		break;
+		return !IsTruthy(right);
 	default:
-		lastValue = nullptr;
-		break;
+		return LoxValue();
 	}
 }
 
-void Interpreter::VisitVariableExpr(VariableExpr& expr)
+template <typename Instrumentation>
+LoxValue BasicInterpreter<Instrumentation>::VisitVariableExpr(VariableExpr& expr)
 {
-	lastValue = environment->Get(expr.name);
+	if (expr.depth < 0)
+	{
+		return globals.Get(expr.name);
+	}
+	return environment->GetAt(expr.depth, expr.slot);
 }
 
-void Interpreter::VisitAssignExpr(AssignExpr& expr)
+template <typename Instrumentation>
+LoxValue BasicInterpreter<Instrumentation>::VisitAssignExpr(AssignExpr& expr)
 {
 	auto value = Evaluate(*expr.value);
-	environment->Assign(expr.name, value);
-	lastValue = value;
+	if (expr.depth < 0)
+	{
+		globals.Assign(expr.name, value);
+	}
+	else
+	{
+		environment->AssignAt(expr.depth, expr.slot, value);
+	}
+	return value;
 }
 
-void Interpreter::VisitLogicalExpr(LogicalExpr& expr)
+template <typename Instrumentation>
+LoxValue BasicInterpreter<Instrumentation>::VisitLogicalExpr(LogicalExpr& expr)
 {
 	auto left = Evaluate(*expr.left);
 
@@ -184,68 +241,103 @@ void Interpreter::VisitLogicalExpr(LogicalExpr& expr)
 	{
 		if (IsTruthy(left))
 		{
-			lastValue = left;
-			return;
+			return left;
 		}
 	}
 	else if (expr.op.type == TokenType::AND)
 	{
 		if (!IsTruthy(left))
 		{
-			lastValue = left;
-			return;
+			return left;
 		}
 	}
 
-	lastValue = Evaluate(*expr.right);
+	return Evaluate(*expr.right);
+}
+
+//superinstructions. the fast path needs number operands, anything else evaluates the
+//replaced tree, which also raises its runtime errors
+template <typename Instrumentation>
+LoxValue BasicInterpreter<Instrumentation>::VisitIncrementExpr(IncrementExpr& expr)
+{
+	LoxValue& value = environment->At(expr.depth, expr.slot);
+	if (!IsNumber(value)) return Evaluate(*expr.original);
+	value = AsNumber(value) + expr.amount;
+	return value;
+}
+
+template <typename Instrumentation>
+LoxValue BasicInterpreter<Instrumentation>::VisitCompareExpr(CompareExpr& expr)
+{
+	return Test(expr);
 }
 
 //stmt visitor methods
-void Interpreter::VisitExpressionStmt(ExpressionStmt& stmt)
+template <typename Instrumentation>
+void BasicInterpreter<Instrumentation>::VisitExpressionStmt(ExpressionStmt& stmt)
 {
 	Evaluate(*stmt.expression);
 }
 
-void Interpreter::VisitPrintStmt(PrintStmt& stmt)
+template <typename Instrumentation>
+void BasicInterpreter<Instrumentation>::VisitPrintStmt(PrintStmt& stmt)
 {
-	auto value = Evaluate(*stmt.expression);
-	std::cout << Stringify(value) << "\n";
+	output.Print(Evaluate(*stmt.expression));
 }
 
-void Interpreter::VisitVarStmt(VarStmt& stmt) {
-	LoxValue value = std::monostate{};
+template <typename Instrumentation>
+void BasicInterpreter<Instrumentation>::VisitVarStmt(VarStmt& stmt) {
+	LoxValue value;
 	if (stmt.initializer) {
 		value = Evaluate(*stmt.initializer);
 	}
-	environment->Define(stmt.name.lexeme, value);
+	if (stmt.slot < 0)
+	{
+		environment->Define(stmt.name, std::move(value));
+		return;
+	}
+	environment->DefineAt(stmt.slot, std::move(value));
 }
 
-void Interpreter::VisitBlockStmt(BlockStmt& stmt)
+template <typename Instrumentation>
+void BasicInterpreter<Instrumentation>::VisitBlockStmt(BlockStmt& stmt)
 {
-	//create a new environment for the block
+	//a block that declares no variables runs in the enclosing environment
+	if (stmt.slotCount == 0)
+	{
+		for (const auto& statement : stmt.statements)
+		{
+			if (!statement) continue; //skip null statements
+			Execute(*statement);
+		}
+		return;
+	}
+
+	//take the next environment off the stack for the block
 	auto previous = environment;
-	environment = std::make_shared<Environment>(previous);
+	environment = frames.Push(previous, stmt.slotCount);
 	try
 	{
 		for (const auto& statement : stmt.statements)
 		{
 			if (!statement) continue; //skip null statements
-			//Execute(*statement);
-			statement->Accept(*this);
+			Execute(*statement);
 		}
 	}
 	catch (...)//handle exceptions of any type, but could change this
 	{
+		frames.Pop();
 		environment = previous;
 		throw;
 	}
+	frames.Pop();
 	environment = previous;
 }
 
-void Interpreter::VisitIfStmt(IfStmt& stmt)
+template <typename Instrumentation>
+void BasicInterpreter<Instrumentation>::VisitIfStmt(IfStmt& stmt)
 {
-	auto condition = Evaluate(*stmt.condition);
-	if (IsTruthy(condition))
+	if (stmt.compare ? Test(*stmt.compare) : IsTruthy(Evaluate(*stmt.condition)))
 	{
 		Execute(*stmt.thenBranch);
 	}
@@ -255,63 +347,61 @@ void Interpreter::VisitIfStmt(IfStmt& stmt)
 	}
 }
 
-void Interpreter::VisitWhileStmt(WhileStmt& stmt)
+template <typename Instrumentation>
+void BasicInterpreter<Instrumentation>::VisitWhileStmt(WhileStmt& stmt)
 {
-	while (IsTruthy(Evaluate(*stmt.condition)))
+	//a fused condition is tested straight away, without making a value
+	while (stmt.compare ? Test(*stmt.compare) : IsTruthy(Evaluate(*stmt.condition)))
 	{
 		Execute(*stmt.body);
 	}
 }
 
 //some helper methods
-LoxValue Interpreter::Evaluate(Expr& expr)
+template <typename Instrumentation>
+LoxValue BasicInterpreter<Instrumentation>::Evaluate(Expr& expr)
 {
-	expr.Accept(*this);
-	return lastValue;
+	typename Instrumentation::Scope scope(instrumentation, expr);
+	return expr.Accept(*this);
 }
 
-void Interpreter::Execute(Stmt& stmt)
+template <typename Instrumentation>
+bool BasicInterpreter<Instrumentation>::Test(CompareExpr& expr)
 {
-	stmt.Accept(*this);
-}
-
-bool Interpreter::IsTruthy(const LoxValue& value) const
-{
-	if (std::holds_alternative<std::monostate>(value)) return false;
-	if (std::holds_alternative<bool>(value)) return std::get<bool>(value);
-	return true;
-}
-
-bool Interpreter::IsEqual(const LoxValue& a, const LoxValue& b) const
-{
-	//handle equals for all variant possibilities
-	if (a.index() != b.index()) return false;
+	typename Instrumentation::Scope scope(instrumentation, expr);
+	const LoxValue& left = environment->GetAt(expr.left.depth, expr.left.slot);
+	if (!IsNumber(left)) return IsTruthy(Evaluate(*expr.original));
+	double a = AsNumber(left);
+	double b = expr.constant;
+	if (expr.right)
+	{
+		const LoxValue& right = environment->GetAt(expr.right->depth, expr.right->slot);
+		if (!IsNumber(right)) return IsTruthy(Evaluate(*expr.original));
+		b = AsNumber(right);
+	}
 
-	//if (std::holds_alternative<std::monostate>(a)) return true;
-	if (std::holds_alternative<std::monostate>(a) && std::holds_alternative<std::monostate>(b)) return true;
-	if (std::holds_alternative<double>(a)) return std::get<double>(a) == std::get<double>(b);
-	if (std::holds_alternative<std::string>(a)) return std::get<std::string>(a) == std::get<std::string>(b);
-	if (std::holds_alternative<bool>(a)) return std::get<bool>(a) == std::get<bool>(b);
-	return false;
+	switch (expr.op)
+	{
+	case TokenType::LESS: return a < b;
+	case TokenType::LESS_EQUAL: return a <= b;
+	case TokenType::GREATER: return a > b;
+	default: return a >= b;
+	}
 }
 
-std::string Interpreter::Stringify(const LoxValue& value) const
+template <typename Instrumentation>
+void BasicInterpreter<Instrumentation>::Execute(Stmt& stmt)
 {
-	if (std::holds_alternative<std::monostate>(value)) return "nil";
-	if (std::holds_alternative<double>(value))
+	typename Instrumentation::Scope scope(instrumentation, stmt);
+	if (profiler)
 	{
-		auto number = std::get<double>(value);
-		std::string text = std::to_string(number);
-		//remove trailing .0 for whole numbers
-		if (text.find('.') != std::string::npos)
-		{
-			text.erase(text.find_last_not_of('0') + 1, std::string::npos);
-			if (text.back() == '.') text.pop_back();
-		}
-		return text;
+		profiler->Enter(stmt);
+		stmt.Accept(*this);
+		profiler->Leave();
+		return;
 	}
-	if (std::holds_alternative<std::string>(value)) return std::get<std::string>(value);
-	if (std::holds_alternative<bool>(value)) return std::get<bool>(value) ? "true" : "false";
-	return "nil";
+	stmt.Accept(*this);
 }
 
+template class BasicInterpreter<NoInstrumentation>;
+template class BasicInterpreter<ExecutionCounters>;
\ No newline at end of file
@@ -1,26 +1,53 @@
 #pragma once
 #include "Expr.h"
 #include "Stmt.h"
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include "Environment.h"
+#include "OutputSink.h"
+#include "Profiler.h"
+#include "Instrumentation.h"
 
-class Interpreter : public Expr::Visitor, public Stmt::Visitor
+//counts for the type feedback on BinaryExpr. hits took the number-only path, misses
+//found other operands there and deoptimised the node, generic went through the full operator switch.
+struct InlineCacheStats
+{
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t generic = 0;
+};
+
+//expressions are evaluated by return value, statements are executed for their effects.
+//Instrumentation is a policy from Instrumentation.h, it sees every node the interpreter visits.
+//only the two aliases below are instantiated, in Interpreter.cpp
+template <typename Instrumentation>
+class BasicInterpreter : public Expr::ValueVisitor, public Stmt::Visitor
 {
 public:
-	Interpreter() = default;
+	explicit BasicInterpreter(OutputSink& output = StandardOutput()) : output(output) {}
+
+	//interpret list of statements. expects the statements to have been through the Resolver.
+	//false when a runtime error stopped them
+	bool Interpret(const std::vector<StmtPtr>& statements);
 
-	//interpret list of statements
-	void Interpret(const std::vector<std::unique_ptr<Stmt>>& statements);
+	const InlineCacheStats& CacheStats() const { return cacheStats; }
+
+	//samples the statements being executed during every Interpret, null turns it off again
+	void SetProfiler(Profiler* profiler) { this->profiler = profiler; }
+
+	Instrumentation& GetInstrumentation() { return instrumentation; }
 
 	//expr visitor methods
-	void VisitBinaryExpr(BinaryExpr& expr) override;
-	void VisitGroupingExpr(GroupingExpr& expr) override;
-	void VisitLiteralExpr(LiteralExpr& expr) override;
-	void VisitUnaryExpr(UnaryExpr& expr) override;
-	void VisitVariableExpr(VariableExpr& expr) override;
-	void VisitAssignExpr(AssignExpr& expr) override;
-	void VisitLogicalExpr(LogicalExpr& expr) override;
+	LoxValue VisitBinaryExpr(BinaryExpr& expr) override;
+	LoxValue VisitGroupingExpr(GroupingExpr& expr) override;
+	LoxValue VisitLiteralExpr(LiteralExpr& expr) override;
+	LoxValue VisitUnaryExpr(UnaryExpr& expr) override;
+	LoxValue VisitVariableExpr(VariableExpr& expr) override;
+	LoxValue VisitAssignExpr(AssignExpr& expr) override;
+	LoxValue VisitLogicalExpr(LogicalExpr& expr) override;
+	LoxValue VisitIncrementExpr(IncrementExpr& expr) override;
+	LoxValue VisitCompareExpr(CompareExpr& expr) override;
 
 	//stmt visitor methods
 	void VisitExpressionStmt(ExpressionStmt& stmt) override;
@@ -33,12 +60,21 @@ public:
 
 private:
 	LoxValue Evaluate(Expr& expr);
+	//value of a fused comparison as a bool
+	bool Test(CompareExpr& expr);
+	LoxValue GenericBinary(BinaryExpr& expr, const LoxValue& left, const LoxValue& right);
 	void Execute(Stmt& stmt);
-	bool IsTruthy(const LoxValue& value) const;
-	bool IsEqual(const LoxValue& a, const LoxValue& b) const;
-	std::string Stringify(const LoxValue& value) const;
 
-	LoxValue lastValue;
-	std::shared_ptr<Environment> environment = std::make_shared<Environment>();
+	OutputSink& output;
+	InlineCacheStats cacheStats;
+	Profiler* profiler = nullptr;
+	Instrumentation instrumentation;
+	Environment globals;
+	Environment* environment = &globals;
+	EnvironmentStack frames;
+
+};
 
-};
\ No newline at end of file
+using Interpreter = BasicInterpreter<NoInstrumentation>;
+//counts every node it runs, for --instrument
+using InstrumentedInterpreter = BasicInterpreter<ExecutionCounters>;
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "LineFinder.h"
+
+namespace
+{
+	//stops looking as soon as a line is found
+	class LineFinder : public Expr::Visitor, public Stmt::Visitor
+	{
+	public:
+		int line = 0;
+
+		//expr visitor methods, the left operand comes first in the source
+		void VisitBinaryExpr(BinaryExpr& expr) override
+		{
+			expr.left->Accept(*this);
+			Found(expr.op.line);
+		}
+		void VisitGroupingExpr(GroupingExpr& expr) override { expr.expression->Accept(*this); }
+		void VisitLiteralExpr(LiteralExpr&) override {}
+		void VisitUnaryExpr(UnaryExpr& expr) override { Found(expr.op.line); }
+		void VisitVariableExpr(VariableExpr& expr) override { Found(expr.name.line); }
+		void VisitAssignExpr(AssignExpr& expr) override { Found(expr.name.line); }
+		void VisitLogicalExpr(LogicalExpr& expr) override
+		{
+			expr.left->Accept(*this);
+			Found(expr.op.line);
+		}
+		void VisitIncrementExpr(IncrementExpr& expr) override { expr.original->Accept(*this); }
+		void VisitCompareExpr(CompareExpr& expr) override { expr.original->Accept(*this); }
+
+		//stmt visitor methods
+		void VisitExpressionStmt(ExpressionStmt& stmt) override { stmt.expression->Accept(*this); }
+		void VisitPrintStmt(PrintStmt& stmt) override { stmt.expression->Accept(*this); }
+		void VisitVarStmt(VarStmt& stmt) override { Found(stmt.name.line); }
+		void VisitBlockStmt(BlockStmt& stmt) override
+		{
+			for (const auto& statement : stmt.statements)
+			{
+				if (line != 0) return;
+				if (statement) statement->Accept(*this);
+			}
+		}
+		void VisitIfStmt(IfStmt& stmt) override { stmt.condition->Accept(*this); }
+		void VisitWhileStmt(WhileStmt& stmt) override { stmt.condition->Accept(*this); }
+
+	private:
+		void Found(int tokenLine)
+		{
+			if (line == 0) line = tokenLine;
+		}
+	};
+}
+
+int FirstLine(Expr& expr)
+{
+	LineFinder finder;
+	expr.Accept(finder);
+	return finder.line;
+}
+
+int FirstLine(Stmt& stmt)
+{
+	LineFinder finder;
+	stmt.Accept(finder);
+	return finder.line;
+}
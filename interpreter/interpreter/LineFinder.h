@@ -0,0 +1,9 @@
+#pragma once
+#include "Expr.h"
+#include "Stmt.h"
+
+//line of the first token in a tree, in source order. statements keep no line of their own, so
+//this is how the Profiler and the execution counters place them. 0 when the tree has no token,
+//like a literal or an empty block
+int FirstLine(Expr& expr);
+int FirstLine(Stmt& stmt);
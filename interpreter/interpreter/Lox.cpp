@@ -1,29 +1,48 @@
 #include "Lox.h"
 #include "Scanner.h"
-#include <iostream>
+#include <chrono>
 #include <fstream>
+#include <iostream>
+#include "MappedFile.h"
+#include <algorithm>
 #include "Parser.h"
 #include "AstPrinter.h"
+#include "Compiler.h"
+#include "Optimizer.h"
+#include "Fuser.h"
+#include "AstCache.h"
+#include "StatementStream.h"
+#include "SpscQueue.h"
+#include "ParallelScanner.h"
+#include <memory>
+#include <sstream>
+#include <thread>
 
 bool Lox::hadError = false;
 bool Lox::hadRuntimeError = false;
 
-void Lox::RunFile(const std::string& path)
+//reports the time since the previous lap for --timings
+class PhaseTimer
 {
-	std::ifstream file(path);
-	if (!file.is_open())
+public:
+	explicit PhaseTimer(bool enabled) : enabled(enabled), start(std::chrono::steady_clock::now()) {}
+
+	void Lap(const char* phase)
 	{
-		std::cerr << "Could not open file: " << path << "\n";
-		return;
+		if (!enabled) return;
+		auto now = std::chrono::steady_clock::now();
+		std::cerr << "[timing] " << phase << ": " << std::chrono::duration<double, std::milli>(now - start).count() << " ms\n";
+		start = now;
 	}
-	double d;
-	file.read(reinterpret_cast<char*>(&d), sizeof d);
-	int n;
-	std::string s;
-	if (file >> n >> s)
-		std::cout << "read back from file: " << d << ' ' << n << ' ' << s << '\n';
-	
-	Lox::Run(s);
+
+private:
+	bool enabled;
+	std::chrono::steady_clock::time_point start;
+};
+
+//closes the output of a script that had errors
+static void ReportFailure()
+{
 	if (Lox::hadError)
 	{
 		Lox::Error(0, "some error");
@@ -33,11 +52,107 @@ void Lox::RunFile(const std::string& path)
 		Lox::Error(0, "some runtime error");
 	}
 }
+
+//one top-level statement of a stream, parsed and waiting to run. its errors are reported when it
+//runs, so they come out in source order however far ahead it was parsed
+struct ParsedStatement
+{
+	//most statements are a line or two, the arena grows for the ones that are not
+	Arena arena{ 1024 };
+	std::vector<StmtPtr> statements;
+	std::vector<int> unexpectedCharacters;
+	std::string syntaxErrors;
+	bool hadError = false;
+};
+
+//takes the next statement off the stream and parses it, null at the end. touches nothing the
+//running program uses, so it can run on a thread of its own
+static std::unique_ptr<ParsedStatement> ParseNext(StatementStream& stream, std::vector<Token>& tokens, std::ostringstream& errors)
+{
+	if (!stream.Next(tokens)) return nullptr;
+	auto parsed = std::make_unique<ParsedStatement>();
+	parsed->unexpectedCharacters = stream.UnexpectedCharacters();
+	Parser parser(tokens, parsed->arena, errors);
+	parsed->statements = parser.Parse();
+	parsed->hadError = parser.HadError();
+	parsed->syntaxErrors = errors.str();
+	errors.str("");
+	return parsed;
+}
+
+//stops and joins the producer of a queue however its consumer leaves, also when a statement
+//throws. the closed queue turns the next push away instead of the rest of the input being parsed
+template <typename T>
+struct ProducerJoin
+{
+	SpscQueue<T>& queue;
+	std::thread& producer;
+
+	~ProducerJoin()
+	{
+		queue.Close();
+		producer.join();
+	}
+};
+
+void Lox::RunFile(const std::string& path)
+{
+	if (options.stream)
+	{
+		std::ifstream input(path, std::ios::binary);
+		if (!input)
+		{
+			std::cerr << "Could not open file: " << path << "\n";
+			return;
+		}
+		RunStream(input);
+		ReportFailure();
+		return;
+	}
+
+	//the scanner works directly on the mapped file, the source is never copied.
+	//pages are read in as the scanner reaches them, so with a mapping that cost shows up under scan
+	PhaseTimer timer(options.timings);
+	MappedFile file(path);
+	if (!file.IsOpen())
+	{
+		std::cerr << "Could not open file: " << path << "\n";
+		return;
+	}
+	timer.Lap("load");
+	if (options.profile)
+	{
+		if (options.engine != Engine::TreeWalk) std::cerr << "--profile only samples the treewalk interpreter\n";
+		interpreter.SetProfiler(&profiler);
+	}
+	if (options.instrument && options.engine != Engine::TreeWalk)
+	{
+		std::cerr << "--instrument only counts in the treewalk interpreter\n";
+	}
+
+	if (options.astCache) RunCached(path, file.Contents());
+	else Lox::Run(file.Contents());
+	StandardOutput().Flush();
+	if (options.profile)
+	{
+		profiler.Report(std::cerr, file.Contents());
+		std::ofstream folded(path + ".folded");
+		size_t slash = path.find_last_of("/\\");
+		profiler.WriteCollapsed(folded, slash == std::string::npos ? path : path.substr(slash + 1));
+	}
+	if (options.instrument && options.engine == Engine::TreeWalk)
+	{
+		instrumented.GetInstrumentation().Report(std::cerr, file.Contents());
+	}
+	ReportFailure();
+}
 void Lox::RunPrompt()
 {
 	//suport multi line input if { is not closed
 	std::string buffer;
 	int openBraces = 0;
+	//whatever a line prints shows up before the next prompt, even inside a long loop
+	StandardOutput().SetInteractive(true);
 
 	while (true) {
 		
@@ -61,20 +176,169 @@ void Lox::RunPrompt()
 		Lox::hadRuntimeError = false;
 	}
 }
-void Lox::Run(const std::string & source)
+void Lox::Run(std::string_view source)
+{
+	hadError = false;
+	hadRuntimeError = false;
+	PhaseTimer timer(options.timings);
+	Arena arena;
+	auto statements = Parse(source, arena, timer);
+	if (hadError) return;
+	Execute(statements, arena, timer);
+}
+
+void Lox::RunStream(std::istream& input)
 {
 	hadError = false;
 	hadRuntimeError = false;
-	Scanner scanner(source);
-	auto tokens = scanner.ScanTokens();
+	if (options.astCache || options.profile)
+	{
+		std::cerr << "--cache and --profile need the whole program, they are ignored with --stream\n";
+		interpreter.SetProfiler(nullptr);
+	}
+	//the passes of every statement are timed together with the rest
+	PhaseTimer timer(options.timings);
+	StatementStream stream(input);
+	std::vector<Token> tokens;
+	std::ostringstream errors;
+	bool running = true;
+	if (options.pipeline)
+	{
+		//the producer leaves interning to the Resolver on this thread
+		stream.SetInterning(false);
+		SpscQueue<std::unique_ptr<ParsedStatement>> queue(256);
+		std::thread producer([&]() {
+			while (auto parsed = ParseNext(stream, tokens, errors))
+			{
+				if (!queue.Push(std::move(parsed))) return;
+			}
+			queue.Push(nullptr);
+		});
+		ProducerJoin<std::unique_ptr<ParsedStatement>> join{ queue, producer };
+		while (auto parsed = queue.Pop()) running = RunParsed(*parsed, running);
+	}
+	else
+	{
+		while (auto parsed = ParseNext(stream, tokens, errors)) running = RunParsed(*parsed, running);
+	}
+	StandardOutput().Flush();
+	timer.Lap("stream");
+	if (options.cacheStats && options.engine == Engine::TreeWalk && !options.instrument) ReportCacheStats();
+	if (options.instrument && options.engine == Engine::TreeWalk)
+	{
+		instrumented.GetInstrumentation().Report(std::cerr, "");
+	}
+}
+
+bool Lox::RunParsed(ParsedStatement& parsed, bool running)
+{
+	for (int line : parsed.unexpectedCharacters) Lox::Error(line, "Unexpected character.");
+	//what the statements before printed goes out ahead of these errors, as Report does
+	if (!parsed.syntaxErrors.empty()) StandardOutput().Flush();
+	std::cerr << parsed.syntaxErrors;
+	if (parsed.hadError) hadError = true;
+	//after an error the rest is only parsed, to report its syntax errors
+	if (!running || hadError) return false;
+	PhaseTimer statementTimer(false);
+	return Execute(parsed.statements, parsed.arena, statementTimer);
+}
 
-	Parser parser(tokens);
-	auto expression = parser.Parse();
+void Lox::RunCached(const std::string& path, std::string_view source)
+{
+	hadError = false;
+	hadRuntimeError = false;
+	PhaseTimer timer(options.timings);
+	std::string cachePath = path + ".cache";
+	Arena arena;
+	std::vector<StmtPtr> statements;
+	if (AstCache::Read(cachePath, source, arena, statements))
+	{
+		timer.Lap("cache load");
+		Execute(statements, arena, timer);
+		return;
+	}
 
+	//the tree is saved before the passes rewrite it. a program with syntax errors is not saved,
+	//so its errors are reported again on the next run
+	statements = Parse(source, arena, timer);
 	if (hadError) return;
+	AstCache::Write(cachePath, source, statements);
+	timer.Lap("cache write");
+	Execute(statements, arena, timer);
+}
+
+std::vector<StmtPtr> Lox::Parse(std::string_view source, Arena& arena, PhaseTimer& timer)
+{
+	std::vector<Token> tokens;
+	unsigned threads = options.scanThreads ? options.scanThreads : std::thread::hardware_concurrency();
+	if (threads > 1 && source.size() >= 2 * ParallelScanner::minChunkSize)
+	{
+		ThreadPool pool(threads);
+		tokens = ParallelScanner(source, pool).ScanTokens();
+	}
+	else
+	{
+		Scanner scanner(source);
+		tokens = scanner.ScanTokens();
+	}
+	timer.Lap("scan");
+
+	Parser parser(tokens, arena);
+	auto statements = parser.Parse();
+	if (parser.HadError()) hadError = true;
+	timer.Lap("parse");
+	return statements;
+}
+
+bool Lox::Execute(std::vector<StmtPtr>& expression, Arena& arena, PhaseTimer& timer)
+{
+	if (!resolver.Resolve(expression)) return false;
+	timer.Lap("resolve");
 
-	Lox::interpreter.Interpret(expression);
+	if (options.dumpAst) std::cerr << "ast before optimizing:\n" << AstPrinter().Print(expression);
+	Optimizer optimizer(arena);
+	optimizer.Optimize(expression);
+	Fuser fuser(arena);
+	fuser.Fuse(expression);
+	timer.Lap("optimize");
+	if (options.dumpAst) std::cerr << "ast after optimizing and fusing:\n" << AstPrinter().Print(expression);
 
+	if (options.engine == Engine::Bytecode)
+	{
+		Compiler compiler;
+		Chunk chunk = compiler.Compile(expression);
+		if (hadError) return false;
+		timer.Lap("compile");
+		bool completed = vm.Interpret(chunk);
+		timer.Lap("execute");
+		return completed;
+	}
+	if (options.engine == Engine::Closures)
+	{
+		bool completed = closures.Interpret(expression);
+		timer.Lap("execute");
+		return completed;
+	}
+
+	if (options.instrument)
+	{
+		bool completed = instrumented.Interpret(expression);
+		timer.Lap("execute");
+		return completed;
+	}
+
+	bool completed = Lox::interpreter.Interpret(expression);
+	timer.Lap("execute");
+	//a stream reports them once, at its end
+	if (options.cacheStats && !options.stream) ReportCacheStats();
+	return completed;
+}
+
+void Lox::ReportCacheStats() const
+{
+	const InlineCacheStats& stats = interpreter.CacheStats();
+	std::cerr << "inline cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+		<< stats.generic << " generic\n";
 }
 
 void Lox::Error(int line, std::string message)
@@ -92,6 +356,8 @@ void Lox::TrackRuntimeError(const RuntimeError& message)
 
 void Lox::Report(int line, std::string where, std::string message)
 {
+	//a stream has run statements before this one, their output is still buffered
+	StandardOutput().Flush();
 	std::cerr << "[line " << line << "] Error " << where << ": " << message << "\n";
 	hadError = true;
 }
\ No newline at end of file
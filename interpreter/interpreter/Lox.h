@@ -1,24 +1,95 @@
 #pragma once
+#include <istream>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "Arena.h"
+#include "Stmt.h"
 #include "RuntimeError.h"
 #include "Interpreter.h"
+#include "VM.h"
+#include "ClosureCompiler.h"
+#include "Resolver.h"
+#include "Profiler.h"
+
+//which back end executes the parsed program
+enum class Engine
+{
+	TreeWalk,
+	Bytecode,
+	Closures
+};
+
+//switches set from the command line
+struct LoxOptions
+{
+	Engine engine = Engine::TreeWalk;
+	//print the AST before and after the Optimizer to stderr
+	bool dumpAst = false;
+	//print the BinaryExpr inline cache counters of the treewalk interpreter after each run
+	bool cacheStats = false;
+	//print how long loading, scanning, parsing, the passes and execution took to stderr
+	bool timings = false;
+	//load the parsed program from <script>.cache when it was made from the same source, write it otherwise
+	bool astCache = false;
+	//sample the treewalk interpreter while a script runs, report the hot lines and write <script>.folded
+	bool profile = false;
+	//run the treewalk interpreter with ExecutionCounters and print how often each source line ran
+	bool instrument = false;
+	//with instrument, also time every node
+	bool instrumentTime = false;
+	//read the script a chunk at a time and run each top-level statement as soon as it is parsed
+	bool stream = false;
+	//with stream, scan and parse on a second thread while the statements parsed so far run
+	bool pipeline = false;
+	//threads that scan a large script together, 0 for one per core
+	unsigned scanThreads = 0;
+};
+
+class PhaseTimer;
+struct ParsedStatement;
 
 class Lox
 {
 public:
+	explicit Lox(LoxOptions options = LoxOptions()) : options(options)
+	{
+		instrumented.GetInstrumentation().SetTimed(options.instrumentTime);
+	}
+
 	static bool hadError;
 	static bool hadRuntimeError;
 
 	void RunFile(const std::string& path);
 	void RunPrompt();
+	//runs a script of any size in memory bounded by its largest top-level statement. each statement
+	//is parsed, run and freed before the next is read, so the statements before a syntax or runtime
+	//error have already run when it is reported
+	void RunStream(std::istream& input);
 
 	static void Error(int line, std::string message);
 	static void TrackRuntimeError(const RuntimeError& message);
 
 private:
-	void Run(const std::string& source);
+	void Run(std::string_view source);
+	//RunFile with --cache, skips scanning and parsing when the cache matches the source
+	void RunCached(const std::string& path, std::string_view source);
+	std::vector<StmtPtr> Parse(std::string_view source, Arena& arena, PhaseTimer& timer);
+	//resolves, optimizes and executes a parsed program, false if it stopped with an error
+	bool Execute(std::vector<StmtPtr>& statements, Arena& arena, PhaseTimer& timer);
 	
+	//reports the errors of a statement of a stream and runs it while running is still true,
+	//returns whether to run the statements after it
+	bool RunParsed(ParsedStatement& parsed, bool running);
+	//the BinaryExpr inline cache counters of the treewalk interpreter
+	void ReportCacheStats() const;
 	static void Report(int line, std::string where, std::string message);
 
+	LoxOptions options;
+	Resolver resolver;
 	Interpreter interpreter;
+	InstrumentedInterpreter instrumented;
+	VM vm;
+	ClosureCompiler closures;
+	Profiler profiler;
 };
\ No newline at end of file
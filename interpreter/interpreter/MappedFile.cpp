@@ -0,0 +1,196 @@
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+{
+	HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (handle == INVALID_HANDLE_VALUE) return;
+	file = handle;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(handle, &fileSize))
+	{
+		Close();
+		return;
+	}
+	size = static_cast<size_t>(fileSize.QuadPart);
+	open = true;
+	//an empty file cannot be mapped, it simply has no contents
+	if (size == 0) return;
+
+	mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping != nullptr)
+	{
+		data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	if (data == nullptr)
+	{
+		//could not map it, read it in one go instead
+		bool read = ReadAll(size);
+		CloseHandle(handle);
+		file = nullptr;
+		if (mapping != nullptr) CloseHandle(mapping);
+		mapping = nullptr;
+		open = read;
+	}
+}
+
+bool MappedFile::ReadAll(size_t expected)
+{
+	buffer = std::make_unique<char[]>(expected);
+	size = 0;
+	while (size < expected)
+	{
+		DWORD chunk = static_cast<DWORD>(std::min<size_t>(expected - size, 1u << 30));
+		DWORD count = 0;
+		if (!ReadFile(static_cast<HANDLE>(file), buffer.get() + size, chunk, &count, nullptr) || count == 0) break;
+		size += count;
+	}
+	if (size != expected)
+	{
+		buffer.reset();
+		size = 0;
+		return false;
+	}
+	data = buffer.get();
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data != nullptr && !buffer) UnmapViewOfFile(data);
+	buffer.reset();
+	if (mapping != nullptr) CloseHandle(mapping);
+	if (file != nullptr) CloseHandle(file);
+	data = nullptr;
+	mapping = nullptr;
+	file = nullptr;
+	size = 0;
+	open = false;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		::close(fd);
+		return;
+	}
+	if (!S_ISREG(info.st_mode))
+	{
+		//no size to map, e.g. a pipe
+		open = ReadAll(fd, 0);
+		::close(fd);
+		return;
+	}
+
+	size = static_cast<size_t>(info.st_size);
+	open = true;
+	//an empty file cannot be mapped, it simply has no contents
+	if (size > 0)
+	{
+		void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (address == MAP_FAILED)
+		{
+			open = ReadAll(fd, size);
+		}
+		else
+		{
+			data = static_cast<const char*>(address);
+			//the scanner reads front to back exactly once
+			madvise(address, size, MADV_SEQUENTIAL);
+		}
+	}
+	//the mapping keeps the file referenced
+	::close(fd);
+}
+
+bool MappedFile::ReadAll(int fd, size_t expected)
+{
+	//one read of the known size, the loop only continues for short reads and unknown sizes
+	size_t capacity = expected > 0 ? expected : 64 * 1024;
+	buffer = std::make_unique<char[]>(capacity);
+	size = 0;
+	while (true)
+	{
+		if (size == capacity)
+		{
+			if (expected > 0) break;
+			auto grown = std::make_unique<char[]>(capacity * 2);
+			std::memcpy(grown.get(), buffer.get(), size);
+			buffer = std::move(grown);
+			capacity *= 2;
+		}
+		ssize_t count = ::read(fd, buffer.get() + size, capacity - size);
+		if (count < 0)
+		{
+			buffer.reset();
+			size = 0;
+			return false;
+		}
+		if (count == 0) break;
+		size += static_cast<size_t>(count);
+	}
+	data = buffer.get();
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data != nullptr && !buffer) munmap(const_cast<char*>(data), size);
+	buffer.reset();
+	data = nullptr;
+	size = 0;
+	open = false;
+}
+
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		std::swap(data, other.data);
+		std::swap(size, other.size);
+		std::swap(open, other.open);
+		std::swap(buffer, other.buffer);
+#ifdef _WIN32
+		std::swap(file, other.file);
+		std::swap(mapping, other.mapping);
+#endif
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
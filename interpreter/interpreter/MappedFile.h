@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+//read only memory mapping of a whole file. the scanner works directly on Contents(),
+//so token lexemes point into the mapping and it has to outlive them.
+//files that cannot be mapped, like pipes, are read into one buffer instead.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::string& path);
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+
+	bool IsOpen() const { return open; }
+	std::string_view Contents() const { return std::string_view(data, size); }
+
+private:
+	void Close();
+	//reads the file into buffer instead, expected is its length or 0 if unknown
+#ifdef _WIN32
+	bool ReadAll(size_t expected);
+#else
+	bool ReadAll(int fd, size_t expected);
+#endif
+
+	const char* data = nullptr;
+	size_t size = 0;
+	bool open = false;
+	std::unique_ptr<char[]> buffer; //set when the file was read, not mapped
+#ifdef _WIN32
+	void* file = nullptr;
+	void* mapping = nullptr;
+#endif
+};
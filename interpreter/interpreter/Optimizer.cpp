@@ -0,0 +1,210 @@
+#include "Optimizer.h"
+
+void Optimizer::Optimize(std::vector<StmtPtr>& statements)
+{
+	for (auto& statement : statements)
+	{
+		if (!statement) continue; //skipping null statements
+		Optimize(statement);
+	}
+}
+
+//expr visitor methods
+void Optimizer::VisitBinaryExpr(BinaryExpr& expr)
+{
+	Optimize(expr.left);
+	Optimize(expr.right);
+
+	const LoxValue* left = Constant(*expr.left);
+	const LoxValue* right = Constant(*expr.right);
+	if (!left || !right) return;
+
+	//same rules as Interpreter::VisitBinaryExpr, but bail out wherever it would throw
+	bool numbers = IsNumber(*left) && IsNumber(*right);
+	switch (expr.op.type)
+	{
+	case TokenType::PLUS:
+		if (numbers) ReplaceWith(AsNumber(*left) + AsNumber(*right));
+		else if (IsString(*left) && IsString(*right)) ReplaceWith(Concatenate(*left, *right));
+		break;
+	case TokenType::MINUS:
+		if (numbers) ReplaceWith(AsNumber(*left) - AsNumber(*right));
+		break;
+	case TokenType::STAR:
+		if (numbers) ReplaceWith(AsNumber(*left) * AsNumber(*right));
+		break;
+	case TokenType::SLASH:
+		if (numbers && AsNumber(*right) != 0) ReplaceWith(AsNumber(*left) / AsNumber(*right));
+		break;
+	case TokenType::GREATER:
+		if (numbers) ReplaceWith(AsNumber(*left) > AsNumber(*right));
+		break;
+	case TokenType::GREATER_EQUAL:
+		if (numbers) ReplaceWith(AsNumber(*left) >= AsNumber(*right));
+		break;
+	case TokenType::LESS:
+		if (numbers) ReplaceWith(AsNumber(*left) < AsNumber(*right));
+		break;
+	case TokenType::LESS_EQUAL:
+		if (numbers) ReplaceWith(AsNumber(*left) <= AsNumber(*right));
+		break;
+	case TokenType::BANG_EQUAL:
+		ReplaceWith(!IsEqual(*left, *right));
+		break;
+	case TokenType::EQUAL_EQUAL:
+		ReplaceWith(IsEqual(*left, *right));
+		break;
+	default:
+		break;
+	}
+}
+
+void Optimizer::VisitGroupingExpr(GroupingExpr& expr)
+{
+	//grouping only matters to the parser, the inner expression can take its place
+	Optimize(expr.expression);
+	exprReplacement = std::move(expr.expression);
+}
+
+void Optimizer::VisitLiteralExpr(LiteralExpr&)
+{
+}
+
+void Optimizer::VisitUnaryExpr(UnaryExpr& expr)
+{
+	Optimize(expr.right);
+
+	const LoxValue* right = Constant(*expr.right);
+	if (!right) return;
+
+	switch (expr.op.type)
+	{
+	case TokenType::MINUS:
+		if (IsNumber(*right)) ReplaceWith(-AsNumber(*right));
+		break;
+	case TokenType::BANG:
+		ReplaceWith(!IsTruthy(*right));
+		break;
+	default:
+		break;
+	}
+}
+
+void Optimizer::VisitVariableExpr(VariableExpr&)
+{
+}
+
+void Optimizer::VisitAssignExpr(AssignExpr& expr)
+{
+	Optimize(expr.value);
+}
+
+void Optimizer::VisitLogicalExpr(LogicalExpr& expr)
+{
+	Optimize(expr.left);
+	Optimize(expr.right);
+
+	const LoxValue* left = Constant(*expr.left);
+	if (!left) return;
+
+	//a constant left side decides the result on its own, or hands over to the right side
+	bool shortCircuits = expr.op.type == TokenType::OR ? IsTruthy(*left) : !IsTruthy(*left);
+	exprReplacement = shortCircuits ? std::move(expr.left) : std::move(expr.right);
+}
+
+void Optimizer::VisitIncrementExpr(IncrementExpr&)
+{
+}
+
+void Optimizer::VisitCompareExpr(CompareExpr&)
+{
+}
+
+//stmt visitor methods
+void Optimizer::VisitExpressionStmt(ExpressionStmt& stmt)
+{
+	Optimize(stmt.expression);
+}
+
+void Optimizer::VisitPrintStmt(PrintStmt& stmt)
+{
+	Optimize(stmt.expression);
+}
+
+void Optimizer::VisitVarStmt(VarStmt& stmt)
+{
+	if (stmt.initializer) Optimize(stmt.initializer);
+}
+
+void Optimizer::VisitBlockStmt(BlockStmt& stmt)
+{
+	Optimize(stmt.statements);
+}
+
+void Optimizer::VisitIfStmt(IfStmt& stmt)
+{
+	Optimize(stmt.condition);
+	OptimizeBody(stmt.thenBranch);
+	if (stmt.elseBranch) Optimize(stmt.elseBranch);
+
+	const LoxValue* condition = Constant(*stmt.condition);
+	if (!condition) return;
+
+	//only the branch that can run is kept, it may be null if there was no else
+	stmtReplacement = IsTruthy(*condition) ? std::move(stmt.thenBranch) : std::move(stmt.elseBranch);
+	removeStmt = !stmtReplacement;
+}
+
+void Optimizer::VisitWhileStmt(WhileStmt& stmt)
+{
+	Optimize(stmt.condition);
+	OptimizeBody(stmt.body);
+
+	//while (true) has to stay, it is how the program loops forever
+	const LoxValue* condition = Constant(*stmt.condition);
+	removeStmt = condition && !IsTruthy(*condition);
+}
+
+//helper methods
+void Optimizer::Optimize(ExprPtr& expr)
+{
+	expr->Accept(*this);
+	if (exprReplacement)
+	{
+		expr = std::move(exprReplacement);
+	}
+}
+
+void Optimizer::Optimize(StmtPtr& stmt)
+{
+	stmt->Accept(*this);
+	if (removeStmt)
+	{
+		stmt = nullptr;
+		removeStmt = false;
+	}
+	else if (stmtReplacement)
+	{
+		stmt = std::move(stmtReplacement);
+	}
+}
+
+void Optimizer::OptimizeBody(StmtPtr& stmt)
+{
+	Optimize(stmt);
+	if (!stmt)
+	{
+		stmt = arena.Make<BlockStmt>(std::vector<StmtPtr>());
+	}
+}
+
+const LoxValue* Optimizer::Constant(const Expr& expr)
+{
+	auto literal = dynamic_cast<const LiteralExpr*>(&expr);
+	return literal ? &literal->value : nullptr;
+}
+
+void Optimizer::ReplaceWith(LoxValue value)
+{
+	exprReplacement = arena.Make<LiteralExpr>(std::move(value));
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "Expr.h"
+#include "Stmt.h"
+#include "Arena.h"
+#include <vector>
+
+//optimisation pass run after the Resolver. folds constant expressions into literals and
+//removes if branches and while loops whose condition is a constant that never lets them run.
+//an operation that would throw at runtime is left in the tree, so the error is still raised
+//when and where it used to be. dead code is removed after resolving, so static errors in it
+//are still reported.
+class Optimizer : public Expr::Visitor, public Stmt::Visitor
+{
+public:
+	//new nodes are allocated in the arena that owns the tree
+	explicit Optimizer(Arena& arena) : arena(arena) {}
+
+	void Optimize(std::vector<StmtPtr>& statements);
+
+	//expr visitor methods
+	void VisitBinaryExpr(BinaryExpr& expr) override;
+	void VisitGroupingExpr(GroupingExpr& expr) override;
+	void VisitLiteralExpr(LiteralExpr& expr) override;
+	void VisitUnaryExpr(UnaryExpr& expr) override;
+	void VisitVariableExpr(VariableExpr& expr) override;
+	void VisitAssignExpr(AssignExpr& expr) override;
+	void VisitLogicalExpr(LogicalExpr& expr) override;
+	void VisitIncrementExpr(IncrementExpr& expr) override;
+	void VisitCompareExpr(CompareExpr& expr) override;
+
+	//stmt visitor methods
+	void VisitExpressionStmt(ExpressionStmt& stmt) override;
+	void VisitPrintStmt(PrintStmt& stmt) override;
+	void VisitVarStmt(VarStmt& stmt) override;
+	void VisitBlockStmt(BlockStmt& stmt) override;
+	void VisitIfStmt(IfStmt& stmt) override;
+	void VisitWhileStmt(WhileStmt& stmt) override;
+
+private:
+	//visit the node and swap in its replacement, if the visitor made one
+	void Optimize(ExprPtr& expr);
+	//a removed statement becomes null, which every statement list skips
+	void Optimize(StmtPtr& stmt);
+	//for places that need a statement, like the body of a loop
+	void OptimizeBody(StmtPtr& stmt);
+
+	static const LoxValue* Constant(const Expr& expr);
+	void ReplaceWith(LoxValue value);
+
+	Arena& arena;
+	ExprPtr exprReplacement;
+	StmtPtr stmtReplacement;
+	bool removeStmt = false;
+};
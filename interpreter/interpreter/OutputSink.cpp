@@ -0,0 +1,27 @@
+#include "OutputSink.h"
+
+OutputSink::OutputSink(std::ostream& stream, size_t threshold) : stream(stream), threshold(threshold)
+{
+	buffer.reserve(threshold + 256);
+}
+
+void OutputSink::Flush()
+{
+	if (buffer.empty()) return;
+	stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	stream.flush();
+	//clear keeps the capacity, so the buffer is only allocated once
+	buffer.clear();
+}
+
+void OutputSink::SetInteractive(bool interactive)
+{
+	this->interactive = interactive;
+	if (interactive) Flush();
+}
+
+OutputSink& StandardOutput()
+{
+	static OutputSink output(std::cout);
+	return output;
+}
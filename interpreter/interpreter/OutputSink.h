@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include "Value.h"
+
+//where print statements write. output is collected in one reusable buffer and written to the
+//stream in large pieces: when the buffer passes the threshold, on Flush, and when the sink is
+//destroyed at exit. an interactive sink writes every print straight away, for the REPL.
+class OutputSink
+{
+public:
+	explicit OutputSink(std::ostream& stream, size_t threshold = 64 * 1024);
+	OutputSink(const OutputSink&) = delete;
+	OutputSink& operator=(const OutputSink&) = delete;
+	~OutputSink() { Flush(); }
+
+	void Print(const LoxValue& value)
+	{
+		AppendStringified(buffer, value);
+		buffer += '\n';
+		if (interactive || buffer.size() >= threshold) Flush();
+	}
+
+	//writes out everything buffered so far, e.g. before an error goes to stderr
+	void Flush();
+
+	void SetInteractive(bool interactive);
+
+private:
+	std::ostream& stream;
+	std::string buffer;
+	size_t threshold;
+	bool interactive = false;
+};
+
+//sink over std::cout shared by the back ends unless they are given another one
+OutputSink& StandardOutput();
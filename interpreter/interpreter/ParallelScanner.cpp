@@ -0,0 +1,143 @@
+#include "ParallelScanner.h"
+#include "Scanner.h"
+#include "Lox.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+	//whether a piece of source that starts outside of a string literal ends inside one. only
+	//quotes, comments and newlines matter for that
+	bool EndsInString(std::string_view text)
+	{
+		size_t i = 0;
+		while (i < text.size())
+		{
+			char c = text[i++];
+			if (c == '"')
+			{
+				size_t close = text.find('"', i);
+				if (close == std::string_view::npos) return true;
+				i = close + 1;
+			}
+			else if (c == '/' && i < text.size() && text[i] == '/')
+			{
+				size_t newline = text.find('\n', i);
+				if (newline == std::string_view::npos) return false;
+				i = newline + 1;
+			}
+		}
+		return false;
+	}
+
+	struct SourceChunk
+	{
+		//where the cut puts it, and whether it ends inside a string when it starts outside or inside one
+		size_t start = 0;
+		bool endsInString[2] = {};
+		int newlines = 0;
+		//where scanning starts, past a string running into the chunk, and on which line
+		size_t scanStart = 0;
+		int line = 1;
+
+		std::vector<Token> tokens;
+		//lexemes of the distinct names and string literals, the value of a token holds its index
+		std::vector<std::string_view> distinct;
+		std::vector<Scanner::UnexpectedCharacter> unexpected;
+	};
+}
+
+std::vector<Token> ParallelScanner::ScanTokens()
+{
+	size_t count = std::min<size_t>(pool.Size() * 4, source.size() / minChunkSize);
+	if (count < 2) return Scanner(source).ScanTokens();
+
+	std::vector<SourceChunk> chunks;
+	chunks.reserve(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		size_t start = 0;
+		if (i > 0)
+		{
+			size_t newline = source.find('\n', source.size() / count * i);
+			if (newline == std::string_view::npos) break;
+			start = newline + 1;
+		}
+		if (!chunks.empty() && start <= chunks.back().start) continue;
+		chunks.emplace_back();
+		chunks.back().start = start;
+	}
+
+	pool.ParallelFor(chunks.size(), [&](size_t i) {
+		SourceChunk& chunk = chunks[i];
+		size_t end = i + 1 < chunks.size() ? chunks[i + 1].start : source.size();
+		std::string_view text = source.substr(chunk.start, end - chunk.start);
+		chunk.newlines = static_cast<int>(std::count(text.begin(), text.end(), '\n'));
+		chunk.endsInString[0] = EndsInString(text);
+		size_t close = text.find('"');
+		chunk.endsInString[1] = close == std::string_view::npos || EndsInString(text.substr(close + 1));
+	});
+
+	//the first chunk starts outside of a string, which settles all the others
+	bool inString = false;
+	int line = 1;
+	for (SourceChunk& chunk : chunks)
+	{
+		chunk.scanStart = chunk.start;
+		chunk.line = line;
+		if (inString)
+		{
+			size_t close = source.find('"', chunk.start);
+			chunk.scanStart = close == std::string_view::npos ? source.size() : close + 1;
+			chunk.line += static_cast<int>(std::count(source.begin() + chunk.start, source.begin() + chunk.scanStart, '\n'));
+		}
+		inString = chunk.endsInString[inString];
+		line += chunk.newlines;
+	}
+
+	pool.ParallelFor(chunks.size(), [&](size_t i) {
+		SourceChunk& chunk = chunks[i];
+		//a string that runs past the end of the chunk is scanned here and skipped by the next one
+		size_t end = i + 1 < chunks.size() ? chunks[i + 1].scanStart : source.size();
+		Scanner scanner(source.substr(chunk.scanStart, std::max(end, chunk.scanStart) - chunk.scanStart), chunk.line);
+		scanner.SetInterning(false);
+		chunk.tokens = scanner.ScanPiece();
+		chunk.unexpected = scanner.UnexpectedCharacters();
+
+		std::unordered_map<std::string_view, double> indices;
+		for (Token& token : chunk.tokens)
+		{
+			if (token.type != TokenType::IDENTIFIER && token.type != TokenType::STRING) continue;
+			auto [iter, added] = indices.try_emplace(token.lexeme, static_cast<double>(chunk.distinct.size()));
+			if (added) chunk.distinct.push_back(token.lexeme);
+			token.lit = iter->second;
+		}
+	});
+
+	size_t total = 1;
+	for (const SourceChunk& chunk : chunks) total += chunk.tokens.size();
+	std::vector<Token> tokens;
+	tokens.reserve(total);
+	std::vector<LoxValue> values;
+	for (SourceChunk& chunk : chunks)
+	{
+		//string literals are told apart from names by their quotes
+		values.clear();
+		for (std::string_view lexeme : chunk.distinct)
+		{
+			values.push_back(InternString(lexeme[0] == '"' ? lexeme.substr(1, lexeme.size() - 2) : lexeme));
+		}
+		for (Token& token : chunk.tokens)
+		{
+			if (token.type == TokenType::IDENTIFIER || token.type == TokenType::STRING)
+			{
+				token.lit = values[static_cast<size_t>(AsNumber(token.lit))];
+			}
+			tokens.push_back(std::move(token));
+		}
+		std::vector<Token>().swap(chunk.tokens);
+		for (const auto& character : chunk.unexpected) Lox::Error(character.line, "Unexpected character.");
+	}
+	tokens.emplace_back(TokenType::END_OF_FILE, "", LoxValue(), line);
+	return tokens;
+}
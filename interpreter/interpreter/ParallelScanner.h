@@ -0,0 +1,30 @@
+#pragma once
+#include <string_view>
+#include <vector>
+#include "Token.h"
+#include "ThreadPool.h"
+
+//scans a large source on the threads of a pool and gives the same tokens as Scanner::ScanTokens.
+//the source is cut after newlines into chunks. a cheap pass over every chunk, in parallel, works
+//out whether it would end inside a string literal when it starts inside one and when it does not,
+//which chains into the state every chunk really starts in. a chunk that starts inside a string is
+//moved to the end of that string, a newline is never inside a comment. the chunks are then
+//scanned at once, each from the line it starts on.
+//
+//interned strings are not thread safe, so the chunks leave names and string literals without a
+//value (see Scanner::SetInterning) and number the distinct ones. the calling thread interns each
+//of those once and hands the values out while joining the chunks. unexpected characters are
+//reported in source order at the end
+class ParallelScanner
+{
+public:
+	ParallelScanner(std::string_view source, ThreadPool& pool) : source(source), pool(pool) {}
+	std::vector<Token> ScanTokens();
+
+	//a smaller chunk is not worth handing to a thread
+	static constexpr size_t minChunkSize = 1 << 20;
+
+private:
+	std::string_view source;
+	ThreadPool& pool;
+};
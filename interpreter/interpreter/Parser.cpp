@@ -1,9 +1,10 @@
 #include "Parser.h"
+#include <array>
 #include <iostream>
 
-std::vector<std::unique_ptr<Stmt>> Parser::Parse()
+std::vector<StmtPtr> Parser::Parse()
 {
-	std::vector<std::unique_ptr<Stmt>> statements;
+	std::vector<StmtPtr> statements;
 	while (current < tokens.size() && tokens[current].type != TokenType::END_OF_FILE) {
 		statements.push_back(Declaration());
 	}
@@ -12,11 +13,11 @@ std::vector<std::unique_ptr<Stmt>> Parser::Parse()
 
 //statements
 
-std::unique_ptr<Stmt> Parser::Declaration()
+StmtPtr Parser::Declaration()
 {
 	try
 	{
-		if (Match({ TokenType::VAR })) return VarDeclaration();
+		if (Match(TokenType::VAR)) return VarDeclaration();
 		return Statement();
 	}
 	catch (const ParseError&)
@@ -26,16 +27,16 @@ std::unique_ptr<Stmt> Parser::Declaration()
 	}
 }
 
-std::unique_ptr<Stmt> Parser::Statement()
+StmtPtr Parser::Statement()
 {
 	try
 	{
-		//if (Match({ TokenType::VAR })) return VarDeclaration();
+		//if (Match(TokenType::VAR)) return VarDeclaration();
 
-		if (Match({ TokenType::IF })) return IfStatement();
-		if (Match({ TokenType::WHILE })) return WhileStatement();
-		if (Match({ TokenType::PRINT })) return PrintStatement();
-		if (Match({ TokenType::LEFT_BRACE })) return BlockStatement();
+		if (Match(TokenType::IF)) return IfStatement();
+		if (Match(TokenType::WHILE)) return WhileStatement();
+		if (Match(TokenType::PRINT)) return PrintStatement();
+		if (Match(TokenType::LEFT_BRACE)) return BlockStatement();
 		return ExpressionStatement();
 	}
 	catch (const ParseError&)
@@ -45,201 +46,196 @@ std::unique_ptr<Stmt> Parser::Statement()
 	}
 }
 
-std::unique_ptr<Stmt> Parser::PrintStatement()
+StmtPtr Parser::PrintStatement()
 {
 	auto expr = Expression();
 	Consume(TokenType::SEMICOLON, "Expect ';' after expression.");
-	return std::make_unique<PrintStmt>(std::move(expr));
+	return arena.Make<PrintStmt>(std::move(expr));
 }
 
-std::unique_ptr<Stmt> Parser::ExpressionStatement()
+StmtPtr Parser::ExpressionStatement()
 {
 	auto expr = Expression();
 	Consume(TokenType::SEMICOLON, "Expect ';' after expression.");
-	return std::make_unique<ExpressionStmt>(std::move(expr));
+	return arena.Make<ExpressionStmt>(std::move(expr));
 }
 
-std::unique_ptr<Stmt> Parser::VarDeclaration()
+StmtPtr Parser::VarDeclaration()
 {
-	Token name = Consume(TokenType::IDENTIFIER, "Expect variable name.");
+	Token name = Keep(Consume(TokenType::IDENTIFIER, "Expect variable name."));
 
-	std::unique_ptr<Expr> initializer = nullptr;
-	if (Match({ TokenType::EQUAL })) {
+	ExprPtr initializer = nullptr;
+	if (Match(TokenType::EQUAL)) {
 		initializer = Expression();
 	}
 
 	Consume(TokenType::SEMICOLON, "Expect ';' after variable declaration.");
-	return std::make_unique<VarStmt>(name, std::move(initializer));
+	return arena.Make<VarStmt>(name, std::move(initializer));
 }
 
-std::unique_ptr<Stmt> Parser::BlockStatement()
+StmtPtr Parser::BlockStatement()
 {
-	std::vector<std::unique_ptr<Stmt>> statements;
+	std::vector<StmtPtr> statements;
 
 	while (!Check(TokenType::RIGHT_BRACE) && !IsAtEnd()) {
 		statements.push_back(Declaration());
 	}
 
 	Consume(TokenType::RIGHT_BRACE, "Expect '}' after block.");
-	return std::make_unique<BlockStmt>(std::move(statements));
+	return arena.Make<BlockStmt>(std::move(statements));
 }
 
-std::unique_ptr<Stmt> Parser::IfStatement()
+StmtPtr Parser::IfStatement()
 {
 	Consume(TokenType::LEFT_PAREN, "Expect '(' after 'if'.");
 	auto condition = Expression();
 	Consume(TokenType::RIGHT_PAREN, "Expect ')' after if condition.");
 	auto thenBranch = Statement();
-	std::unique_ptr<Stmt> elseBranch = nullptr;
-	if (Match({ TokenType::ELSE })) {
+	StmtPtr elseBranch = nullptr;
+	if (Match(TokenType::ELSE)) {
 		elseBranch = Statement();
 	}
-	return std::make_unique<IfStmt>(std::move(condition), std::move(thenBranch), std::move(elseBranch));
+	return arena.Make<IfStmt>(std::move(condition), std::move(thenBranch), std::move(elseBranch));
 }
 
-std::unique_ptr<Stmt> Parser::WhileStatement()
+StmtPtr Parser::WhileStatement()
 {
 	Consume(TokenType::LEFT_PAREN, "Expect '(' after 'while'.");
 	auto condition = Expression();
 	Consume(TokenType::RIGHT_PAREN, "Expect ')' after condition.");
 	auto body = Statement();
-	return std::make_unique<WhileStmt>(std::move(condition), std::move(body));
+	return arena.Make<WhileStmt>(std::move(condition), std::move(body));
 }
 
 //expressions
 
-std::unique_ptr<Expr> Parser::Expression()
+//indexed by token type. a token without a prefix rule cannot start an expression, one with
+//precedence None ends it
+const Parser::Rule& Parser::GetRule(TokenType type)
 {
-	return Assignment();
+	static constexpr auto rules = [] {
+		std::array<Rule, static_cast<size_t>(TokenType::END_OF_FILE) + 1> table{};
+		auto set = [&table](TokenType type, Rule rule) { table[static_cast<size_t>(type)] = rule; };
+		set(TokenType::LEFT_PAREN, { &Parser::Grouping, nullptr, Precedence::None });
+		set(TokenType::MINUS, { &Parser::Unary, &Parser::Binary, Precedence::Term });
+		set(TokenType::PLUS, { nullptr, &Parser::Binary, Precedence::Term });
+		set(TokenType::SLASH, { nullptr, &Parser::Binary, Precedence::Factor });
+		set(TokenType::STAR, { nullptr, &Parser::Binary, Precedence::Factor });
+		set(TokenType::BANG, { &Parser::Unary, nullptr, Precedence::None });
+		set(TokenType::BANG_EQUAL, { nullptr, &Parser::Binary, Precedence::Equality });
+		set(TokenType::EQUAL, { nullptr, &Parser::Assignment, Precedence::Assignment });
+		set(TokenType::EQUAL_EQUAL, { nullptr, &Parser::Binary, Precedence::Equality });
+		set(TokenType::GREATER, { nullptr, &Parser::Binary, Precedence::Comparison });
+		set(TokenType::GREATER_EQUAL, { nullptr, &Parser::Binary, Precedence::Comparison });
+		set(TokenType::LESS, { nullptr, &Parser::Binary, Precedence::Comparison });
+		set(TokenType::LESS_EQUAL, { nullptr, &Parser::Binary, Precedence::Comparison });
+		set(TokenType::IDENTIFIER, { &Parser::Variable, nullptr, Precedence::None });
+		set(TokenType::STRING, { &Parser::Literal, nullptr, Precedence::None });
+		set(TokenType::NUMBER, { &Parser::Literal, nullptr, Precedence::None });
+		set(TokenType::AND, { nullptr, &Parser::Logical, Precedence::Logical });
+		set(TokenType::OR, { nullptr, &Parser::Logical, Precedence::Logical });
+		set(TokenType::FALSE, { &Parser::Literal, nullptr, Precedence::None });
+		set(TokenType::NIL, { &Parser::Literal, nullptr, Precedence::None });
+		set(TokenType::TRUE, { &Parser::Literal, nullptr, Precedence::None });
+		return table;
+	}();
+	return rules[static_cast<size_t>(type)];
 }
 
-std::unique_ptr<Expr> Parser::Equality()
+//parses an operand, then folds in every following operator that binds at least as tightly as
+//precedence. a literal takes one call instead of a trip down the whole grammar
+ExprPtr Parser::Expression(Precedence precedence)
 {
-	auto expr = Comparison();
+	auto prefix = GetRule(Peek().type).prefix;
+	if (!prefix) throw error(Peek(), "Expect expression.");
+	Advance();
+	auto expr = (this->*prefix)();
 
-	while (Match({ TokenType::BANG_EQUAL, TokenType::EQUAL_EQUAL })) {
-		Token op = Previous();
-		auto right = Comparison();
-		expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
+	for (;;) {
+		const Rule& rule = GetRule(Peek().type);
+		if (rule.precedence == Precedence::None || rule.precedence < precedence) break;
+		Advance();
+		expr = (this->*rule.infix)(std::move(expr));
 	}
 
 	return expr;
 }
 
-std::unique_ptr<Expr> Parser::Comparison()
+ExprPtr Parser::Grouping()
 {
-	auto expr = Term();
-
-	while (Match({ TokenType::GREATER, TokenType::GREATER_EQUAL, TokenType::LESS, TokenType::LESS_EQUAL })) {
-		Token op = Previous();
-		auto right = Term();
-		expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-	}
-
-	return expr;
+	auto expr = Expression();
+	Consume(TokenType::RIGHT_PAREN, "Expect ')' after expression.");
+	return arena.Make<GroupingExpr>(std::move(expr));
 }
 
-std::unique_ptr<Expr> Parser::Term()
+ExprPtr Parser::Unary()
 {
-	auto expr = Factor();
-
-	while (Match({ TokenType::MINUS, TokenType::PLUS })) {
-		Token op = Previous();
-		auto right = Factor();
-		expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-	}
-
-	return expr;
+	Token op = Keep(Previous());
+	auto right = Expression(Precedence::Unary);
+	return arena.Make<UnaryExpr>(op, std::move(right));
 }
 
-std::unique_ptr<Expr> Parser::Factor()
+ExprPtr Parser::Literal()
 {
-	auto expr = Unary();
-
-	while (Match({ TokenType::SLASH, TokenType::STAR })) {
-		Token op = Previous();
-		auto right = Unary();
-		expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
+	switch (Previous().type) {
+	case TokenType::FALSE: return arena.Make<LiteralExpr>(false);
+	case TokenType::TRUE: return arena.Make<LiteralExpr>(true);
+	case TokenType::NIL: return arena.Make<LiteralExpr>(LoxValue());
+	default:
+		//a string scanned without interning gets a string of its own, see Scanner::SetInterning
+		if (Previous().type == TokenType::STRING && IsNil(Previous().lit))
+		{
+			std::string_view lexeme = Previous().lexeme;
+			return arena.Make<LiteralExpr>(LoxValue(std::string(lexeme.substr(1, lexeme.size() - 2))));
+		}
+		return arena.Make<LiteralExpr>(Previous().lit);
 	}
-
-	return expr;
 }
 
-std::unique_ptr<Expr> Parser::Unary()
+ExprPtr Parser::Variable()
 {
-	if (Match({ TokenType::BANG, TokenType::MINUS })) {
-		Token op = Previous();
-		auto right = Unary();
-		return std::make_unique<UnaryExpr>(op, std::move(right));
-	}
-	return Primary();
+	return arena.Make<VariableExpr>(Keep(Previous()));
 }
 
-std::unique_ptr<Expr> Parser::Primary()
+//operators are left associative, so the right operand only takes tighter ones
+ExprPtr Parser::Binary(ExprPtr left)
 {
-	if (Match({ TokenType::FALSE })) return std::make_unique<LiteralExpr>(false);
-	if (Match({ TokenType::TRUE })) return std::make_unique<LiteralExpr>(true);
-	if (Match({ TokenType::NIL })) return std::make_unique<LiteralExpr>(std::monostate{});
-	if (Match({ TokenType::NUMBER, TokenType::STRING })) {
-		return std::make_unique<LiteralExpr>(Previous().lit);
-	}
-	if (Match({ TokenType::IDENTIFIER })) {
-		return std::make_unique<VariableExpr>(Previous());
-	}
-
-	if (Match({ TokenType::LEFT_PAREN })) {
-		auto expr = Expression();
-		Consume(TokenType::RIGHT_PAREN, "Expect ')' after expression.");
-		return std::make_unique<GroupingExpr>(std::move(expr));
-	}
-
-	throw error(Peek(), "Expect expression.");
+	Token op = Keep(Previous());
+	auto precedence = static_cast<Precedence>(static_cast<int>(GetRule(op.type).precedence) + 1);
+	auto right = Expression(precedence);
+	return arena.Make<BinaryExpr>(std::move(left), op, std::move(right));
 }
 
-//check for equals vs assignment, and if assignment then move into left
-std::unique_ptr<Expr> Parser::Assignment()
+ExprPtr Parser::Logical(ExprPtr left)
 {
-	auto expr = Logical();
-
-	if (Match({ TokenType::EQUAL })) {
-		Token equals = Previous();
-		auto value = Assignment();
-
-		if (auto varExpr = dynamic_cast<VariableExpr*>(expr.get())) {
-			Token name = varExpr->name;
-			return std::make_unique<AssignExpr>(name, std::move(value));
-		}
-
-		error(equals, "Invalid assignment target.");
-	}
-
-	return expr;
+	Token op = Keep(Previous());
+	auto right = Expression(Precedence::Equality);
+	return arena.Make<LogicalExpr>(std::move(left), op, std::move(right));
 }
 
-std::unique_ptr<Expr> Parser::Logical()
+//right associative, and only a variable can be assigned to. an invalid target is reported
+//without unwinding and leaves the left side as it was
+ExprPtr Parser::Assignment(ExprPtr left)
 {
-	auto expr = Equality();
+	const Token& equals = Previous();
+	auto value = Expression(Precedence::Assignment);
 
-	while (Match({ TokenType::AND, TokenType::OR })) {
-		Token op = Previous();
-		auto right = Equality();
-		expr = std::make_unique<LogicalExpr>(std::move(expr), op, std::move(right));
+	if (auto varExpr = dynamic_cast<VariableExpr*>(left.get())) {
+		Token name = varExpr->name;
+		return arena.Make<AssignExpr>(name, std::move(value));
 	}
 
-	return expr;
+	error(equals, "Invalid assignment target.");
+	return left;
 }
 
 //helper methods
 
-bool Parser::Match(std::initializer_list<TokenType> types)
+bool Parser::Match(TokenType type)
 {
-	for (TokenType type : types) {
-		if (Check(type)) {
-			Advance();
-			return true;
-		}
-	}
-	return false;
+	if (!Check(type)) return false;
+	Advance();
+	return true;
 }
 
 bool Parser::Check(TokenType type) const
@@ -248,11 +244,10 @@ bool Parser::Check(TokenType type) const
 	return Peek().type == type;
 }
 
-const Token Parser::Advance()
+const Token& Parser::Advance()
 {
 	if (!IsAtEnd()) current++;
-	Token a = Previous();
-	return a;
+	return Previous();
 }
 
 bool Parser::IsAtEnd() const
@@ -260,36 +255,43 @@ bool Parser::IsAtEnd() const
 	return Peek().type == TokenType::END_OF_FILE;
 }
 
-const Token Parser::Peek() const
+const Token& Parser::Peek() const
 {
-	Token a = tokens[current];
-	return a;
+	return tokens[current];
 }
 
-const Token Parser::Previous() const
+const Token& Parser::Previous() const
 {
 	return tokens[current - 1];
 }
 
-const Token Parser::Consume(TokenType type, const std::string& message)
+const Token& Parser::Consume(TokenType type, const std::string& message)
 {
 	if (Check(type)) return Advance();
 	throw error(Peek(), message);
 }
 
+Token Parser::Keep(const Token& token)
+{
+	Token kept = token;
+	kept.lexeme = arena.CopyString(token.lexeme);
+	return kept;
+}
+
 ParseError Parser::error(const Token& token, const std::string& message)
 {
 	//report error to some error handler
-	std::cerr << "[line " << token.line << "] Error";
+	errors << "[line " << token.line << "] Error";
 	if (token.type == TokenType::END_OF_FILE) 
 	{
-		std::cerr << " at end";
+		errors << " at end";
 	}
 	else 
 	{
-		std::cerr << " at '" << token.lexeme << "'";
+		errors << " at '" << token.lexeme << "'";
 	}
-	std::cerr << ": " << message << std::endl;
+	errors << ": " << message << std::endl;
+	hadError = true;
 
 	return ParseError(message);
 }
@@ -1,9 +1,11 @@
 #pragma once
+#include <iostream>
 #include <vector>
 #include <memory>
 #include "Token.h"
 #include "Stmt.h"
 #include <stdexcept>
+#include "Arena.h"
 
 class ParseError : public std::runtime_error
 {
@@ -14,43 +16,65 @@ public:
 class Parser
 {
 public:
-	Parser(const std::vector<Token>& tokens) : tokens(tokens) {}
-	std::vector<std::unique_ptr<Stmt>> Parse();
+	//nodes are allocated in the arena, which must outlive the returned statements. syntax errors
+	//are printed to errors
+	Parser(const std::vector<Token>& tokens, Arena& arena, std::ostream& errors = std::cerr)
+		: tokens(tokens), arena(arena), errors(errors) {}
+	std::vector<StmtPtr> Parse();
+	//after a syntax error the statements have null holes where it was, no pass may see them
+	bool HadError() const { return hadError; }
 
 
 private:
 	const std::vector<Token>& tokens;
-	int current = 0;
+	Arena& arena;
+	std::ostream& errors;
+	size_t current = 0;
+	bool hadError = false;
 
 	//grammar rules
-	std::unique_ptr<Stmt> Statement();
-	std::unique_ptr<Stmt> PrintStatement();
-	std::unique_ptr<Stmt> ExpressionStatement();
-	std::unique_ptr<Stmt> Declaration();
-	std::unique_ptr<Stmt> VarDeclaration();
-	std::unique_ptr<Stmt> BlockStatement();
-	std::unique_ptr<Stmt> IfStatement();
-	std::unique_ptr<Stmt> WhileStatement();
-
-	std::unique_ptr<Expr> Expression();
-	std::unique_ptr<Expr> Equality();
-	std::unique_ptr<Expr> Comparison();
-	std::unique_ptr<Expr> Term();
-	std::unique_ptr<Expr> Factor();
-	std::unique_ptr<Expr> Unary();
-	std::unique_ptr<Expr> Primary();
-	std::unique_ptr<Expr> Assignment();
-	std::unique_ptr<Expr> Logical();
+	StmtPtr Statement();
+	StmtPtr PrintStatement();
+	StmtPtr ExpressionStatement();
+	StmtPtr Declaration();
+	StmtPtr VarDeclaration();
+	StmtPtr BlockStatement();
+	StmtPtr IfStatement();
+	StmtPtr WhileStatement();
 
+	//expressions are parsed by precedence climbing over a table of rules, see GetRule
+	enum class Precedence { None, Assignment, Logical, Equality, Comparison, Term, Factor, Unary };
+
+	//what a token does at the start of an expression and after a complete operand
+	struct Rule
+	{
+		ExprPtr(Parser::*prefix)();
+		ExprPtr(Parser::*infix)(ExprPtr left);
+		Precedence precedence;
+	};
+	static const Rule& GetRule(TokenType type);
+
+	ExprPtr Expression(Precedence precedence = Precedence::Assignment);
+	//prefix rules, the token is already consumed
+	ExprPtr Grouping();
+	ExprPtr Unary();
+	ExprPtr Literal();
+	ExprPtr Variable();
+	//infix rules, the operator is already consumed
+	ExprPtr Binary(ExprPtr left);
+	ExprPtr Logical(ExprPtr left);
+	ExprPtr Assignment(ExprPtr left);
 
 	//helper methods
-	bool Match(std::initializer_list<TokenType> types);
+	bool Match(TokenType type);
 	bool Check(TokenType type) const;
-	const Token Advance();
+	const Token& Advance();
 	bool IsAtEnd() const;
-	const Token Peek() const;
-	const Token Previous() const;
-	const Token Consume(TokenType type, const std::string& message);
+	const Token& Peek() const;
+	const Token& Previous() const;
+	const Token& Consume(TokenType type, const std::string& message);
+	//copy of a token for the AST, with its lexeme moved into the arena
+	Token Keep(const Token& token);
 	ParseError error(const Token& token, const std::string& message);
 	void Synchronise();
 
@@ -0,0 +1,138 @@
+#include "Profiler.h"
+#include "LineFinder.h"
+#include <algorithm>
+#include <iomanip>
+#include <set>
+
+namespace
+{
+	//names a frame after the kind of statement, the line is added from FirstLine
+	class FrameNamer : public Stmt::Visitor
+	{
+	public:
+		std::string name;
+
+		void VisitExpressionStmt(ExpressionStmt&) override { name = "expr"; }
+		void VisitPrintStmt(PrintStmt&) override { name = "print"; }
+		void VisitVarStmt(VarStmt& stmt) override { name = "var " + std::string(stmt.name.lexeme); }
+		void VisitBlockStmt(BlockStmt&) override { name = "block"; }
+		void VisitIfStmt(IfStmt&) override { name = "if"; }
+		void VisitWhileStmt(WhileStmt&) override { name = "while"; }
+	};
+}
+
+void Profiler::Start()
+{
+	if (running) return;
+	running = true;
+	sampler = std::thread([this]()
+	{
+		while (running.load(std::memory_order_relaxed))
+		{
+			std::this_thread::sleep_for(interval);
+			Sample();
+		}
+	});
+}
+
+void Profiler::Stop()
+{
+	if (!running) return;
+	running = false;
+	sampler.join();
+	Resolve();
+}
+
+void Profiler::Sample()
+{
+	int count = std::min(published.load(std::memory_order_acquire), maxDepth);
+	//nothing is running, the interpreter is between statements at the top level or not started
+	if (count == 0) return;
+	std::vector<Stmt*> stack(count);
+	for (int i = 0; i < count; ++i)
+	{
+		stack[i] = frames[i].load(std::memory_order_relaxed);
+	}
+	++stacks[stack];
+}
+
+void Profiler::Resolve()
+{
+	FrameNamer namer;
+	for (const auto& [stack, count] : stacks)
+	{
+		std::string path;
+		std::set<int> seen;
+		int innermost = 0;
+		for (Stmt* stmt : stack)
+		{
+			if (!stmt) continue;
+			stmt->Accept(namer);
+			int line = FirstLine(*stmt);
+			if (!path.empty()) path += ';';
+			path += namer.name;
+			if (line != 0) path += ":" + std::to_string(line);
+			innermost = line;
+			seen.insert(line);
+		}
+		samples += count;
+		collapsed[path] += count;
+		lines[innermost].self += count;
+		for (int line : seen) lines[line].total += count;
+	}
+	stacks.clear();
+}
+
+void Profiler::Report(std::ostream& out, std::string_view source) const
+{
+	out << "profile: " << samples << " samples, one every " << interval.count() << " us\n";
+	if (samples == 0) return;
+
+	std::vector<std::pair<int, LineSamples>> hottest(lines.begin(), lines.end());
+	std::sort(hottest.begin(), hottest.end(), [](const auto& a, const auto& b)
+	{
+		return a.second.self != b.second.self ? a.second.self > b.second.self : a.second.total > b.second.total;
+	});
+	if (hottest.size() > 20) hottest.resize(20);
+
+	//the text of the reported lines, found in one pass over the source
+	std::set<int> wanted;
+	for (const auto& entry : hottest) wanted.insert(entry.first);
+	std::map<int, std::string_view> text;
+	int line = 1;
+	size_t start = 0;
+	for (int target : wanted)
+	{
+		if (target < 1) continue;
+		while (line < target && start < source.size())
+		{
+			size_t newline = source.find('\n', start);
+			start = newline == std::string_view::npos ? source.size() : newline + 1;
+			++line;
+		}
+		size_t end = std::min(source.find('\n', start), source.size());
+		std::string_view code = source.substr(start, end - start);
+		size_t first = code.find_first_not_of(" \t\r");
+		text[target] = first == std::string_view::npos ? std::string_view() : code.substr(first);
+	}
+
+	out << std::fixed << std::setprecision(1);
+	out << "   line   self %  total %  code\n";
+	for (const auto& [number, counts] : hottest)
+	{
+		out << std::setw(7);
+		if (number == 0) out << "?";
+		else out << number;
+		out << std::setw(8) << 100.0 * counts.self / samples << "%"
+			<< std::setw(8) << 100.0 * counts.total / samples << "%  " << text[number] << "\n";
+	}
+	out << std::defaultfloat;
+}
+
+void Profiler::WriteCollapsed(std::ostream& out, const std::string& root) const
+{
+	for (const auto& [path, count] : collapsed)
+	{
+		out << root << ';' << path << ' ' << count << '\n';
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "Stmt.h"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+//sampling profiler for the treewalk interpreter, used by --profile. the Interpreter tells it which
+//statements it is inside of, and a sampler thread copies that stack at a fixed interval. the copy
+//is not synchronised with the interpreter, a sample taken while a statement is entered or left
+//can be off by one frame, which does not matter once there are many of them.
+//samples are turned into frames named after the statement and its source line when sampling
+//stops, so Stop has to be called while the tree is still alive.
+class Profiler
+{
+public:
+	explicit Profiler(std::chrono::microseconds interval = std::chrono::microseconds(1000)) : interval(interval) {}
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+	~Profiler() { Stop(); }
+
+	void Start();
+	void Stop();
+
+	//called by the interpreter around every statement it executes
+	void Enter(Stmt& stmt)
+	{
+		if (depth < maxDepth) frames[depth].store(&stmt, std::memory_order_relaxed);
+		published.store(++depth, std::memory_order_release);
+	}
+	void Leave() { published.store(--depth, std::memory_order_release); }
+	//a runtime error unwinds past the Leave calls
+	void Unwind()
+	{
+		depth = 0;
+		published.store(0, std::memory_order_release);
+	}
+
+	//hottest source lines by the samples spent in them (self) and under them (total)
+	void Report(std::ostream& out, std::string_view source) const;
+	//one line per distinct stack, frames separated by ';' and the sample count last, as read by flamegraph.pl
+	void WriteCollapsed(std::ostream& out, const std::string& root) const;
+
+private:
+	static constexpr int maxDepth = 256;
+
+	void Sample();
+	void Resolve();
+
+	std::chrono::microseconds interval;
+	std::atomic<Stmt*> frames[maxDepth] = {};
+	int depth = 0; //only touched by the interpreter thread
+	std::atomic<int> published{ 0 };
+
+	std::thread sampler;
+	std::atomic<bool> running{ false };
+	//owned by the sampler thread while it runs
+	std::map<std::vector<Stmt*>, size_t> stacks;
+
+	struct LineSamples
+	{
+		size_t self = 0;
+		size_t total = 0;
+	};
+	size_t samples = 0;
+	std::map<std::string, size_t> collapsed;
+	std::map<int, LineSamples> lines;
+};
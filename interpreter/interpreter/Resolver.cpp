@@ -0,0 +1,182 @@
+#include "Resolver.h"
+#include "Lox.h"
+#include <algorithm>
+
+bool Resolver::Resolve(const std::vector<StmtPtr>& statements)
+{
+	hadError = false;
+	declaredGlobals.clear();
+	scopes.clear();
+	for (const auto& statement : statements)
+	{
+		if (!statement) continue; //skipping null statements
+		Resolve(*statement);
+	}
+	//globals of a program that fails to resolve never get defined
+	if (hadError)
+	{
+		for (const LoxValue& name : declaredGlobals) globals.erase(name);
+	}
+	return !hadError;
+}
+
+//expr visitor methods
+void Resolver::VisitBinaryExpr(BinaryExpr& expr)
+{
+	Resolve(*expr.left);
+	Resolve(*expr.right);
+}
+
+void Resolver::VisitGroupingExpr(GroupingExpr& expr)
+{
+	Resolve(*expr.expression);
+}
+
+void Resolver::VisitLiteralExpr(LiteralExpr&)
+{
+}
+
+void Resolver::VisitUnaryExpr(UnaryExpr& expr)
+{
+	Resolve(*expr.right);
+}
+
+void Resolver::VisitVariableExpr(VariableExpr& expr)
+{
+	ResolveName(expr.name, expr.depth, expr.slot);
+}
+
+void Resolver::VisitAssignExpr(AssignExpr& expr)
+{
+	Resolve(*expr.value);
+	ResolveName(expr.name, expr.depth, expr.slot);
+}
+
+void Resolver::VisitLogicalExpr(LogicalExpr& expr)
+{
+	Resolve(*expr.left);
+	Resolve(*expr.right);
+}
+
+void Resolver::VisitIncrementExpr(IncrementExpr& expr)
+{
+	Resolve(*expr.original);
+}
+
+void Resolver::VisitCompareExpr(CompareExpr& expr)
+{
+	Resolve(*expr.original);
+}
+
+//stmt visitor methods
+void Resolver::VisitExpressionStmt(ExpressionStmt& stmt)
+{
+	Resolve(*stmt.expression);
+}
+
+void Resolver::VisitPrintStmt(PrintStmt& stmt)
+{
+	Resolve(*stmt.expression);
+}
+
+void Resolver::VisitVarStmt(VarStmt& stmt)
+{
+	Intern(stmt.name);
+	//the initializer runs before the variable exists, so 'var a = a;' refers to an outer 'a'
+	if (stmt.initializer)
+	{
+		Resolve(*stmt.initializer);
+	}
+
+	if (scopes.empty())
+	{
+		if (globals.insert(stmt.name.lit).second) declaredGlobals.push_back(stmt.name.lit);
+		stmt.slot = -1;
+		return;
+	}
+
+	//redeclaring a name in the same block reuses its slot
+	auto& scope = scopes.back();
+	auto iter = scope.find(stmt.name.lexeme);
+	if (iter == scope.end())
+	{
+		iter = scope.emplace(stmt.name.lexeme, static_cast<int>(scope.size())).first;
+	}
+	stmt.slot = iter->second;
+}
+
+void Resolver::VisitBlockStmt(BlockStmt& stmt)
+{
+	//a block that declares nothing gets no scope, and slotCount 0 tells the back ends
+	//to run it in the enclosing environment
+	bool declares = std::any_of(stmt.statements.begin(), stmt.statements.end(),
+		[](const StmtPtr& statement) { return dynamic_cast<VarStmt*>(statement.get()) != nullptr; });
+	if (declares) scopes.emplace_back();
+	for (const auto& statement : stmt.statements)
+	{
+		if (!statement) continue; //skip null statements
+		Resolve(*statement);
+	}
+	stmt.slotCount = 0;
+	if (declares)
+	{
+		stmt.slotCount = static_cast<int>(scopes.back().size());
+		scopes.pop_back();
+	}
+}
+
+void Resolver::VisitIfStmt(IfStmt& stmt)
+{
+	Resolve(*stmt.condition);
+	Resolve(*stmt.thenBranch);
+	if (stmt.elseBranch)
+	{
+		Resolve(*stmt.elseBranch);
+	}
+}
+
+void Resolver::VisitWhileStmt(WhileStmt& stmt)
+{
+	Resolve(*stmt.condition);
+	Resolve(*stmt.body);
+}
+
+//some helper methods
+void Resolver::Resolve(Expr& expr)
+{
+	expr.Accept(*this);
+}
+
+void Resolver::Resolve(Stmt& stmt)
+{
+	stmt.Accept(*this);
+}
+
+void Resolver::Intern(Token& name)
+{
+	if (IsNil(name.lit)) name.lit = InternString(name.lexeme);
+}
+
+void Resolver::ResolveName(Token& name, int& depth, int& slot)
+{
+	Intern(name);
+	for (int i = static_cast<int>(scopes.size()) - 1; i >= 0; --i)
+	{
+		auto iter = scopes[i].find(name.lexeme);
+		if (iter != scopes[i].end())
+		{
+			depth = static_cast<int>(scopes.size()) - 1 - i;
+			slot = iter->second;
+			return;
+		}
+	}
+
+	depth = -1;
+	slot = -1;
+	//statements run in order, so a global that has not been declared yet can never be defined here
+	if (globals.find(name.lit) == globals.end())
+	{
+		Lox::Error(name.line, "undefined variable '" + std::string(name.lexeme) + "'.");
+		hadError = true;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "Expr.h"
+#include "Stmt.h"
+#include <vector>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+//static pass run between the parser and the interpreter. gives every local variable a
+//(depth, slot) pair so the interpreter can skip name lookups, and reports reads of
+//variables that can never be defined at that point as compile time errors.
+//globals declared by earlier runs are remembered, so a REPL session keeps working.
+class Resolver : public Expr::Visitor, public Stmt::Visitor
+{
+public:
+	//returns false if an error was reported
+	bool Resolve(const std::vector<StmtPtr>& statements);
+
+	//expr visitor methods
+	void VisitBinaryExpr(BinaryExpr& expr) override;
+	void VisitGroupingExpr(GroupingExpr& expr) override;
+	void VisitLiteralExpr(LiteralExpr& expr) override;
+	void VisitUnaryExpr(UnaryExpr& expr) override;
+	void VisitVariableExpr(VariableExpr& expr) override;
+	void VisitAssignExpr(AssignExpr& expr) override;
+	void VisitLogicalExpr(LogicalExpr& expr) override;
+	void VisitIncrementExpr(IncrementExpr& expr) override;
+	void VisitCompareExpr(CompareExpr& expr) override;
+
+	//stmt visitor methods
+	void VisitExpressionStmt(ExpressionStmt& stmt) override;
+	void VisitPrintStmt(PrintStmt& stmt) override;
+	void VisitVarStmt(VarStmt& stmt) override;
+	void VisitBlockStmt(BlockStmt& stmt) override;
+	void VisitIfStmt(IfStmt& stmt) override;
+	void VisitWhileStmt(WhileStmt& stmt) override;
+
+private:
+	void Resolve(Expr& expr);
+	void Resolve(Stmt& stmt);
+	//sets depth and slot, depth stays -1 for globals
+	void ResolveName(Token& name, int& depth, int& slot);
+	//names scanned on another thread come without their interned string (see
+	//Scanner::SetInterning), they get it here on the thread that runs them
+	static void Intern(Token& name);
+
+	//one map of name -> slot per enclosing block, innermost last
+	std::vector<std::unordered_map<std::string_view, int>> scopes;
+	//interned names, so they outlive the AST of the run that declared them
+	std::unordered_set<LoxValue, LoxValueHash, LoxValueEqual> globals;
+	//the ones new in this run, taken out again if it fails. a script streamed one statement at a
+	//time runs the resolver once per statement, so it must not copy all of them
+	std::vector<LoxValue> declaredGlobals;
+	bool hadError = false;
+};
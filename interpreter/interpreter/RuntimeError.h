@@ -9,5 +9,8 @@ public:
 	Token token;
 	RuntimeError(const Token& token, const std::string& message)
 			: std::runtime_error(message), token(token) {}
+	//for errors raised by the vm, which only knows the source line
+	RuntimeError(int line, const std::string& message)
+			: std::runtime_error(message), token(TokenType::END_OF_FILE, "", LoxValue(), line) {}
 		const Token& getToken() const { return token; }
 };
\ No newline at end of file
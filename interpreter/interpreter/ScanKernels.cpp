@@ -0,0 +1,251 @@
+#include "ScanKernels.h"
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define LOX_SCAN_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+//gcc and clang only emit avx2 instructions in functions marked for it, msvc always can
+#if defined(__GNUC__)
+#define LOX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define LOX_TARGET_AVX2
+#endif
+
+namespace
+{
+	inline bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	//bit counts without relying on the popcnt instruction, which SSE2-only cpus may lack
+	inline int CountBits(uint32_t bits)
+	{
+		bits = bits - ((bits >> 1) & 0x55555555);
+		bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+		return static_cast<int>((((bits + (bits >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24);
+	}
+
+	inline int LowestBit(uint32_t bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, bits);
+		return static_cast<int>(index);
+#else
+		return __builtin_ctz(bits);
+#endif
+	}
+
+	//bits below the lowest set bit of mask
+	inline uint32_t Below(uint32_t mask)
+	{
+		return (mask & (0u - mask)) - 1;
+	}
+
+	//scalar versions, also used for the tail that is shorter than a vector
+
+	const char* SkipWhitespaceScalar(const char* begin, const char* end, int& line)
+	{
+		while (begin < end && IsSpace(*begin))
+		{
+			if (*begin == '\n') line++;
+			begin++;
+		}
+		return begin;
+	}
+
+	const char* FindLineEndScalar(const char* begin, const char* end)
+	{
+		while (begin < end && *begin != '\n') begin++;
+		return begin;
+	}
+
+	const char* FindQuoteScalar(const char* begin, const char* end, int& line)
+	{
+		while (begin < end && *begin != '"')
+		{
+			if (*begin == '\n') line++;
+			begin++;
+		}
+		return begin;
+	}
+
+#ifdef LOX_SCAN_X86
+
+	const char* SkipWhitespaceSse2(const char* begin, const char* end, int& line)
+	{
+		const __m128i space = _mm_set1_epi8(' ');
+		const __m128i tab = _mm_set1_epi8('\t');
+		const __m128i carriage = _mm_set1_epi8('\r');
+		const __m128i newline = _mm_set1_epi8('\n');
+		while (end - begin >= 16)
+		{
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+			__m128i newlines = _mm_cmpeq_epi8(chunk, newline);
+			__m128i spaces = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, carriage), newlines));
+			uint32_t other = ~static_cast<uint32_t>(_mm_movemask_epi8(spaces)) & 0xffff;
+			uint32_t lines = static_cast<uint32_t>(_mm_movemask_epi8(newlines));
+			if (other != 0)
+			{
+				line += CountBits(lines & Below(other));
+				return begin + LowestBit(other);
+			}
+			line += CountBits(lines);
+			begin += 16;
+		}
+		return SkipWhitespaceScalar(begin, end, line);
+	}
+
+	const char* FindLineEndSse2(const char* begin, const char* end)
+	{
+		const __m128i newline = _mm_set1_epi8('\n');
+		while (end - begin >= 16)
+		{
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+			uint32_t found = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+			if (found != 0) return begin + LowestBit(found);
+			begin += 16;
+		}
+		return FindLineEndScalar(begin, end);
+	}
+
+	const char* FindQuoteSse2(const char* begin, const char* end, int& line)
+	{
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i newline = _mm_set1_epi8('\n');
+		while (end - begin >= 16)
+		{
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+			uint32_t quotes = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)));
+			uint32_t lines = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+			if (quotes != 0)
+			{
+				line += CountBits(lines & Below(quotes));
+				return begin + LowestBit(quotes);
+			}
+			line += CountBits(lines);
+			begin += 16;
+		}
+		return FindQuoteScalar(begin, end, line);
+	}
+
+	LOX_TARGET_AVX2 const char* SkipWhitespaceAvx2(const char* begin, const char* end, int& line)
+	{
+		const __m256i space = _mm256_set1_epi8(' ');
+		const __m256i tab = _mm256_set1_epi8('\t');
+		const __m256i carriage = _mm256_set1_epi8('\r');
+		const __m256i newline = _mm256_set1_epi8('\n');
+		while (end - begin >= 32)
+		{
+			__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+			__m256i newlines = _mm256_cmpeq_epi8(chunk, newline);
+			__m256i spaces = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(chunk, carriage), newlines));
+			uint32_t other = ~static_cast<uint32_t>(_mm256_movemask_epi8(spaces));
+			uint32_t lines = static_cast<uint32_t>(_mm256_movemask_epi8(newlines));
+			if (other != 0)
+			{
+				line += CountBits(lines & Below(other));
+				return begin + LowestBit(other);
+			}
+			line += CountBits(lines);
+			begin += 32;
+		}
+		return SkipWhitespaceSse2(begin, end, line);
+	}
+
+	LOX_TARGET_AVX2 const char* FindLineEndAvx2(const char* begin, const char* end)
+	{
+		const __m256i newline = _mm256_set1_epi8('\n');
+		while (end - begin >= 32)
+		{
+			__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+			uint32_t found = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+			if (found != 0) return begin + LowestBit(found);
+			begin += 32;
+		}
+		return FindLineEndSse2(begin, end);
+	}
+
+	LOX_TARGET_AVX2 const char* FindQuoteAvx2(const char* begin, const char* end, int& line)
+	{
+		const __m256i quote = _mm256_set1_epi8('"');
+		const __m256i newline = _mm256_set1_epi8('\n');
+		while (end - begin >= 32)
+		{
+			__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+			uint32_t quotes = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote)));
+			uint32_t lines = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+			if (quotes != 0)
+			{
+				line += CountBits(lines & Below(quotes));
+				return begin + LowestBit(quotes);
+			}
+			line += CountBits(lines);
+			begin += 32;
+		}
+		return FindQuoteSse2(begin, end, line);
+	}
+
+	bool CpuHasAvx2()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+		__cpuid(info, 1);
+		//the os has to save the ymm registers too
+		bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+		__cpuidex(info, 7, 0);
+		return osSavesYmm && (info[1] & (1 << 5));
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	const ScanKernels sse2Kernels = { "sse2", SkipWhitespaceSse2, FindLineEndSse2, FindQuoteSse2 };
+	const ScanKernels avx2Kernels = { "avx2", SkipWhitespaceAvx2, FindLineEndAvx2, FindQuoteAvx2 };
+
+#endif
+
+	const ScanKernels scalarKernels = { "scalar", SkipWhitespaceScalar, FindLineEndScalar, FindQuoteScalar };
+}
+
+const ScanKernels& ScanKernels::Scalar()
+{
+	return scalarKernels;
+}
+
+const ScanKernels* ScanKernels::Sse2()
+{
+#ifdef LOX_SCAN_X86
+	//part of the x86-64 baseline, and of every 32 bit cpu msvc still targets
+	return &sse2Kernels;
+#else
+	return nullptr;
+#endif
+}
+
+const ScanKernels* ScanKernels::Avx2()
+{
+#ifdef LOX_SCAN_X86
+	static const bool supported = CpuHasAvx2();
+	return supported ? &avx2Kernels : nullptr;
+#else
+	return nullptr;
+#endif
+}
+
+const ScanKernels& ScanKernels::Active()
+{
+	static const ScanKernels& active = Avx2() ? *Avx2() : Sse2() ? *Sse2() : Scalar();
+	return active;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+
+//byte skipping loops used by the Scanner on the hot paths that do not produce tokens:
+//runs of whitespace, the rest of a // comment and the body of a string literal.
+//every function scans [begin, end), returns where it stopped and adds the newlines it
+//passed over to line. there is a scalar version and SSE2/AVX2 versions that look at 16/32
+//bytes per step; the best one the cpu supports is picked at runtime.
+struct ScanKernels
+{
+	const char* name;
+	//first byte that is not ' ', '\t', '\r' or '\n'
+	const char* (*skipWhitespace)(const char* begin, const char* end, int& line);
+	//the next '\n', which is not consumed and so not counted
+	const char* (*findLineEnd)(const char* begin, const char* end);
+	//the next '"', counting the newlines inside the string
+	const char* (*findQuote)(const char* begin, const char* end, int& line);
+
+	//chosen once per process from the cpu features
+	static const ScanKernels& Active();
+	static const ScanKernels& Scalar();
+	//nullptr when the cpu or compiler does not support them
+	static const ScanKernels* Sse2();
+	static const ScanKernels* Avx2();
+};
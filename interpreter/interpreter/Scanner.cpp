@@ -1,26 +1,55 @@
 #include "Scanner.h"
 #include "Lox.h"
+#include <charconv>
 
-const std::unordered_map<std::string, TokenType> Scanner::keywords = {
-	{"and", TokenType::AND}, {"class", TokenType::CLASS}, {"else", TokenType::ELSE},
-	{"false", TokenType::FALSE}, {"for", TokenType::FOR}, {"fun", TokenType::FUN},
-	{"if", TokenType::IF}, {"nil", TokenType::NIL}, {"or", TokenType::OR},
-	{"print", TokenType::PRINT}, {"return", TokenType::RETURN}, {"super", TokenType::SUPER},
-	{"this", TokenType::THIS}, {"true", TokenType::TRUE}, {"var", TokenType::VAR},
-	{"while", TokenType::WHILE}
-};
+//the recogniser is evaluated at compile time here, so a broken keyword fails the build
+static_assert(Scanner::KeywordType("and") == TokenType::AND);
+static_assert(Scanner::KeywordType("class") == TokenType::CLASS);
+static_assert(Scanner::KeywordType("else") == TokenType::ELSE);
+static_assert(Scanner::KeywordType("false") == TokenType::FALSE);
+static_assert(Scanner::KeywordType("for") == TokenType::FOR);
+static_assert(Scanner::KeywordType("fun") == TokenType::FUN);
+static_assert(Scanner::KeywordType("if") == TokenType::IF);
+static_assert(Scanner::KeywordType("nil") == TokenType::NIL);
+static_assert(Scanner::KeywordType("or") == TokenType::OR);
+static_assert(Scanner::KeywordType("print") == TokenType::PRINT);
+static_assert(Scanner::KeywordType("return") == TokenType::RETURN);
+static_assert(Scanner::KeywordType("super") == TokenType::SUPER);
+static_assert(Scanner::KeywordType("this") == TokenType::THIS);
+static_assert(Scanner::KeywordType("true") == TokenType::TRUE);
+static_assert(Scanner::KeywordType("var") == TokenType::VAR);
+static_assert(Scanner::KeywordType("while") == TokenType::WHILE);
+static_assert(Scanner::KeywordType("f") == TokenType::IDENTIFIER);
+static_assert(Scanner::KeywordType("t") == TokenType::IDENTIFIER);
+static_assert(Scanner::KeywordType("variable") == TokenType::IDENTIFIER);
+static_assert(Scanner::KeywordType("fo") == TokenType::IDENTIFIER);
+static_assert(Scanner::KeywordType("thisx") == TokenType::IDENTIFIER);
 
 std::vector<Token> Scanner::ScanTokens()
 {
+	//roughly one token per five bytes of source, saves regrowing the vector on big files
+	tokens.reserve(source.size() / 5 + 1);
 	while (!IsAtEnd())
 	{
 		start = current;
 		ScanToken();
 	}
-	tokens.emplace_back(Token(TokenType::END_OF_FILE, "", std::monostate{}, line));
+	tokens.emplace_back(Token(TokenType::END_OF_FILE, "", LoxValue(), line));
 	return tokens;
 }
 
+std::vector<Token> Scanner::ScanPiece()
+{
+	piece = true;
+	tokens.reserve(source.size() / 5 + 1);
+	while (!IsAtEnd())
+	{
+		start = current;
+		ScanToken();
+	}
+	return std::move(tokens);
+}
+
 bool Scanner::IsAtEnd() const
 {
 	return current >= source.length();
@@ -44,20 +73,20 @@ char Scanner::PeekNext() const
 
 void Scanner::AddToken(TokenType type)
 {
-	Scanner::AddToken(type, "");
+	//only string and number tokens carry a literal
+	tokens.emplace_back(type, Lexeme(), LoxValue(), line);
 }
 
 //void AddToken(TokenType type, std::variant<std::monostate, double, std::string> literal) {}
 
-void Scanner::AddToken(TokenType type, const std::string literal)
+//string literals and identifier names are interned
+void Scanner::AddToken(TokenType type, std::string_view literal)
 	{
-	std::string text = source.substr(start, current - start);
-	tokens.emplace_back(type, text, literal, line);
+	tokens.emplace_back(type, Lexeme(), intern ? InternString(literal) : LoxValue(), line);
 }
 
 void Scanner::AddToken(TokenType type, double number) {
-	std::string text = source.substr(start, current - start);
-	tokens.emplace_back(type, text, number, line);
+	tokens.emplace_back(type, Lexeme(), number, line);
 }
 
 void Scanner::ScanToken()
@@ -76,25 +105,41 @@ void Scanner::ScanToken()
 	case ';': AddToken(TokenType::SEMICOLON); break;
 	case '*': AddToken(TokenType::STAR); break;
 	case '!':
-		AddToken(Peek() == '=' ? TokenType::BANG_EQUAL : TokenType::BANG);
-		if (Peek() == '=') Advance();
+		if (Peek() == '=')
+		{
+			Advance();
+			AddToken(TokenType::BANG_EQUAL);
+		}
+		else AddToken(TokenType::BANG);
 		break;
 	case '=':
-		AddToken(Peek() == '=' ? TokenType::EQUAL_EQUAL : TokenType::EQUAL);
-		if (Peek() == '=') Advance();
+		if (Peek() == '=')
+		{
+			Advance();
+			AddToken(TokenType::EQUAL_EQUAL);
+		}
+		else AddToken(TokenType::EQUAL);
 		break;
 	case '<':
-		AddToken(Peek() == '=' ? TokenType::LESS_EQUAL : TokenType::LESS);
-		if (Peek() == '=') Advance();
+		if (Peek() == '=')
+		{
+			Advance();
+			AddToken(TokenType::LESS_EQUAL);
+		}
+		else AddToken(TokenType::LESS);
 		break;
 	case '>':
-		AddToken(Peek() == '=' ? TokenType::GREATER_EQUAL : TokenType::GREATER);
-		if (Peek() == '=') Advance();
+		if (Peek() == '=')
+		{
+			Advance();
+			AddToken(TokenType::GREATER_EQUAL);
+		}
+		else AddToken(TokenType::GREATER);
 		break;
 	case '/':
 		if (Peek() == '/')
 		{
-			while (Peek() != '\n' && !IsAtEnd()) Advance();
+			SkipTo(kernels.findLineEnd(source.data() + current, source.data() + source.size()));
 		}
 		else
 		{
@@ -104,9 +149,18 @@ void Scanner::ScanToken()
 	case ' ':
 	case '\r':
 	case '\t':
-		break;
 	case '\n':
-		line++;
+		if (c == '\n') line++;
+		//single spaces between tokens are the common case, only runs are worth a kernel call
+		switch (Peek())
+		{
+		case ' ':
+		case '\r':
+		case '\t':
+		case '\n':
+			SkipTo(kernels.skipWhitespace(source.data() + current, source.data() + source.size(), line));
+			break;
+		}
 		break;
 	case '"': String(); break;
 	default:
@@ -114,6 +168,10 @@ void Scanner::ScanToken()
 			Number();
 		else if (IsAlpha(c))
 			Identifier();
+		else if (piece)
+		{
+			unexpected.push_back({ start, line });
+		}
 		else
 		{
 			Lox::Error(line, "Unexpected character.");
@@ -123,19 +181,22 @@ void Scanner::ScanToken()
 }
 void Scanner::String()
 {
-	while (Peek() != '"' && !IsAtEnd())
-	{
-		if (Peek() == '\n') line++;
-		Advance();
-	}
+	int startLine = line;
+	SkipTo(kernels.findQuote(source.data() + current, source.data() + source.size(), line));
 	if (IsAtEnd())
 	{
 		//Lox::Error(line, "Unterminated string.");
+		if (piece)
+		{
+			//it may end in the next piece, which then starts at the quote
+			source = source.substr(0, start);
+			current = start;
+			line = startLine;
+		}
 		return;
 	}
 	Advance();
-	std::string value = source.substr(start + 1, current - start - 2);
-	AddToken(TokenType::STRING, value);
+	AddToken(TokenType::STRING, source.substr(start + 1, current - start - 2));
 }
 
 void Scanner::Number()
@@ -146,25 +207,36 @@ void Scanner::Number()
 		Advance();
 		while (IsDigit(Peek())) Advance();
 	}
-	double value = std::stod(source.substr(start, current - start));
+	double value = 0;
+	std::from_chars(source.data() + start, source.data() + current, value);
 	AddToken(TokenType::NUMBER, value);
 }
 
 void Scanner::Identifier()
 {
 	while (IsAlphaNumeric(Peek())) Advance();
-	std::string text = source.substr(start, current - start);
-	auto keyword = keywords.find(text);
-	if (keyword != keywords.end())
+	std::string_view text = Lexeme();
+	TokenType type = KeywordType(text);
+	if (type != TokenType::IDENTIFIER)
 	{
-		AddToken(keyword->second);
+		AddToken(type);
 	}
 	else
 	{
-		AddToken(TokenType::IDENTIFIER);
+		AddToken(TokenType::IDENTIFIER, text);
 	}
 }
 
+void Scanner::SkipTo(const char* position)
+{
+	current = static_cast<size_t>(position - source.data());
+}
+
+std::string_view Scanner::Lexeme() const
+{
+	return source.substr(start, current - start);
+}
+
 bool Scanner::IsDigit(char c) const
 {
 	return c >= '0' && c <= '9';
@@ -1,29 +1,104 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include "Token.h"
-#include <unordered_map>
+#include "ScanKernels.h"
 
+//scans the source in place: token lexemes are views into it and scanning allocates nothing
+//per token, so the source (e.g. a MappedFile) must outlive the tokens
 class Scanner
 {
 public:
-	Scanner(const std::string& source) : source(source) {}
+	explicit Scanner(std::string_view source, const ScanKernels& kernels = ScanKernels::Active())
+		: source(source), kernels(kernels) {}
+	//for a piece of a longer source that starts on the given line, see ScanPiece
+	Scanner(std::string_view source, int line, const ScanKernels& kernels = ScanKernels::Active())
+		: source(source), kernels(kernels), line(line) {}
 	std::vector<Token> ScanTokens();
 
+	//scans a piece of a source that is read a bit at a time, cut after a newline so that only a
+	//string literal can run past its end. that string is left for the next piece instead of
+	//dropped, and no END_OF_FILE is added. Scanned() and Line() are where the next piece starts
+	std::vector<Token> ScanPiece();
+	size_t Scanned() const { return current; }
+	int Line() const { return line; }
+	//a piece does not report its unexpected characters, they are reported with the statement
+	//they turn up in
+	struct UnexpectedCharacter
+	{
+		size_t offset;
+		int line;
+	};
+	const std::vector<UnexpectedCharacter>& UnexpectedCharacters() const { return unexpected; }
+
+	//interned strings are shared by every thread and counted without locking, so a scanner that
+	//runs beside the program leaves identifiers and string literals without a value. the Parser
+	//gives such a string literal a string of its own and the Resolver interns the names
+	void SetInterning(bool intern) { this->intern = intern; }
+
+	//keyword type of an identifier lexeme, or IDENTIFIER. a switch on the first one or two
+	//letters followed by a single compare of the remaining characters, no hashing
+	static constexpr TokenType KeywordType(std::string_view text)
+	{
+		switch (text[0])
+		{
+		case 'a': return CheckKeyword(text, 1, "nd", TokenType::AND);
+		case 'c': return CheckKeyword(text, 1, "lass", TokenType::CLASS);
+		case 'e': return CheckKeyword(text, 1, "lse", TokenType::ELSE);
+		case 'f':
+			if (text.size() > 1)
+			{
+				switch (text[1])
+				{
+				case 'a': return CheckKeyword(text, 2, "lse", TokenType::FALSE);
+				case 'o': return CheckKeyword(text, 2, "r", TokenType::FOR);
+				case 'u': return CheckKeyword(text, 2, "n", TokenType::FUN);
+				}
+			}
+			break;
+		case 'i': return CheckKeyword(text, 1, "f", TokenType::IF);
+		case 'n': return CheckKeyword(text, 1, "il", TokenType::NIL);
+		case 'o': return CheckKeyword(text, 1, "r", TokenType::OR);
+		case 'p': return CheckKeyword(text, 1, "rint", TokenType::PRINT);
+		case 'r': return CheckKeyword(text, 1, "eturn", TokenType::RETURN);
+		case 's': return CheckKeyword(text, 1, "uper", TokenType::SUPER);
+		case 't':
+			if (text.size() > 1)
+			{
+				switch (text[1])
+				{
+				case 'h': return CheckKeyword(text, 2, "is", TokenType::THIS);
+				case 'r': return CheckKeyword(text, 2, "ue", TokenType::TRUE);
+				}
+			}
+			break;
+		case 'v': return CheckKeyword(text, 1, "ar", TokenType::VAR);
+		case 'w': return CheckKeyword(text, 1, "hile", TokenType::WHILE);
+		}
+		return TokenType::IDENTIFIER;
+	}
+
 private:
-	const std::string source;
+	std::string_view source;
+	const ScanKernels& kernels;
 	std::vector<Token> tokens;
-	int start = 0;
-	int current = 0;
+	size_t start = 0;
+	size_t current = 0;
 	int line = 1;
+	bool piece = false;
+	bool intern = true;
+	std::vector<UnexpectedCharacter> unexpected;
 
-	static const std::unordered_map<std::string, TokenType> keywords;
 	bool IsAtEnd() const;
 	char Advance();
 	void AddToken(TokenType type);
 	//void AddToken(TokenType type, std::variant<std::monostate, double, std::string> literal);
-	void AddToken(TokenType type, const std::string literal);
+	void AddToken(TokenType type, std::string_view literal);
 	void AddToken(TokenType type, double number);
+	std::string_view Lexeme() const;
+	//moves current to the position a scan kernel stopped at
+	void SkipTo(const char* position);
 
 	char Peek() const;
 	char PeekNext() const;
@@ -34,4 +109,9 @@ private:
 	bool IsDigit(char c) const;
 	bool IsAlpha(char c) const;
 	bool IsAlphaNumeric(char c) const;
+
+	static constexpr TokenType CheckKeyword(std::string_view text, size_t length, std::string_view rest, TokenType type)
+	{
+		return text.size() == length + rest.size() && text.substr(length) == rest ? type : TokenType::IDENTIFIER;
+	}
 };
\ No newline at end of file
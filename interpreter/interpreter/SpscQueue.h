@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//bounded lock-free queue between exactly one producer thread and one consumer thread. tail is
+//only written by the producer and head only by the consumer, the store of either index hands
+//the slot it moved past to the other side. a full or empty queue is waited on by yielding for a
+//few tries, since only the other thread can change that, and then by sleeping until it does
+template <typename T>
+class SpscQueue
+{
+public:
+	//one slot stays empty to tell a full queue from an empty one
+	explicit SpscQueue(size_t capacity) : slots(capacity + 1) {}
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	//false once the consumer has closed the queue, the value is dropped
+	bool Push(T value)
+	{
+		size_t tail = this->tail.load(std::memory_order_relaxed);
+		size_t next = Next(tail);
+		WaitUntil([&]() { return next != head.load() || closed.load(); });
+		if (closed.load()) return false;
+		slots[tail] = std::move(value);
+		this->tail.store(next);
+		WakeSleeper();
+		return true;
+	}
+
+	T Pop()
+	{
+		size_t head = this->head.load(std::memory_order_relaxed);
+		WaitUntil([&]() { return head != tail.load(); });
+		T value = std::move(slots[head]);
+		this->head.store(Next(head));
+		WakeSleeper();
+		return value;
+	}
+
+	//called by the consumer when it takes nothing more, a producer waiting on a full queue
+	//is let go
+	void Close()
+	{
+		closed.store(true);
+		WakeSleeper();
+	}
+
+private:
+	//a short wait is over before a sleeping thread would even be woken
+	static constexpr int spins = 64;
+
+	size_t Next(size_t index) const { return index + 1 == slots.size() ? 0 : index + 1; }
+
+	//the index stores and the sleeper count are sequentially consistent, so either the waiter
+	//sees the index move before it sleeps or the other thread sees it sleeping and wakes it
+	template <typename Ready>
+	void WaitUntil(Ready ready)
+	{
+		for (int i = 0; i < spins; ++i)
+		{
+			if (ready()) return;
+			std::this_thread::yield();
+		}
+		std::unique_lock<std::mutex> lock(mutex);
+		sleepers.fetch_add(1);
+		changed.wait(lock, ready);
+		sleepers.fetch_sub(1);
+	}
+
+	void WakeSleeper()
+	{
+		if (sleepers.load() == 0) return;
+		//taking the lock waits out a sleeper that has checked but is not waiting yet
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+		}
+		changed.notify_all();
+	}
+
+	std::vector<T> slots;
+	//on their own cache lines, so the two threads do not invalidate each other's index
+	alignas(64) std::atomic<size_t> head{ 0 };
+	alignas(64) std::atomic<size_t> tail{ 0 };
+	alignas(64) std::atomic<int> sleepers{ 0 };
+	std::atomic<bool> closed{ false };
+	std::mutex mutex;
+	std::condition_variable changed;
+};
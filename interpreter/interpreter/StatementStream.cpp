@@ -0,0 +1,110 @@
+#include "StatementStream.h"
+#include <algorithm>
+#include <iterator>
+
+bool StatementStream::Next(std::vector<Token>& statement)
+{
+	size_t end;
+	while ((end = StatementEnd()) == 0)
+	{
+		if (!Fill())
+		{
+			//whatever is left is the last statement, complete or not
+			end = tokens.size();
+			break;
+		}
+	}
+	//unexpected characters after the last statement still come out, with no tokens
+	if (end == next && reported == unexpected.size()) return false;
+
+	//the ones before its last token, those between two statements go with the second
+	size_t bound = buffer.size();
+	if (end > next) bound = tokens[end - 1].lexeme.data() + tokens[end - 1].lexeme.size() - buffer.data();
+	unexpectedLines.clear();
+	while (reported < unexpected.size() && unexpected[reported].offset < bound)
+	{
+		unexpectedLines.push_back(unexpected[reported++].line);
+	}
+
+	statement.assign(tokens.begin() + next, tokens.begin() + end);
+	//on the line of the token that comes next in the script, like a parser of the whole script sees it
+	statement.emplace_back(TokenType::END_OF_FILE, "", LoxValue(), end < tokens.size() ? tokens[end].line : line);
+	next = end;
+	searched = end;
+	depth = 0;
+	return true;
+}
+
+size_t StatementStream::StatementEnd()
+{
+	for (; searched < tokens.size(); ++searched)
+	{
+		TokenType type = tokens[searched].type;
+		if (type == TokenType::LEFT_BRACE) ++depth;
+		if (type != TokenType::SEMICOLON && type != TokenType::RIGHT_BRACE) continue;
+		//whether an else follows is only known once the token after it is scanned
+		if (searched + 1 == tokens.size() && !inputEnded) return 0;
+		if (type == TokenType::RIGHT_BRACE) --depth;
+		if (depth > 0) continue;
+		//a stray '}' ends a statement too
+		depth = 0;
+		if (searched + 1 < tokens.size() && tokens[searched + 1].type == TokenType::ELSE) continue;
+		return searched + 1;
+	}
+	return 0;
+}
+
+bool StatementStream::Fill()
+{
+	if (inputEnded) return false;
+
+	//statements that have been handed out are dropped. the tokens after them point into the
+	//buffer, so they move along with it
+	size_t keep = next < tokens.size() ? tokens[next].lexeme.data() - buffer.data() : scanned;
+	if (reported < unexpected.size()) keep = std::min(keep, unexpected[reported].offset);
+	std::vector<size_t> offsets;
+	offsets.reserve(tokens.size() - next);
+	for (size_t i = next; i < tokens.size(); ++i)
+	{
+		offsets.push_back(tokens[i].lexeme.data() - buffer.data() - keep);
+	}
+	tokens.erase(tokens.begin(), tokens.begin() + next);
+	searched -= next;
+	next = 0;
+	buffer.erase(0, keep);
+	scanned -= keep;
+	unexpected.erase(unexpected.begin(), unexpected.begin() + reported);
+	reported = 0;
+	for (auto& character : unexpected) character.offset -= keep;
+
+	size_t size = buffer.size();
+	buffer.resize(size + chunkSize);
+	input.read(&buffer[size], chunkSize);
+	buffer.resize(size + input.gcount());
+	inputEnded = !input;
+
+	for (size_t i = 0; i < tokens.size(); ++i)
+	{
+		tokens[i].lexeme = std::string_view(buffer.data() + offsets[i], tokens[i].lexeme.size());
+	}
+
+	//the piece is cut after its last newline, so only a string literal can run past it
+	size_t end = buffer.size();
+	if (!inputEnded)
+	{
+		size_t newline = buffer.rfind('\n');
+		end = newline == std::string::npos || newline < scanned ? scanned : newline + 1;
+	}
+	Scanner scanner(std::string_view(buffer).substr(scanned, end - scanned), line);
+	scanner.SetInterning(intern);
+	std::vector<Token> piece = scanner.ScanPiece();
+	tokens.insert(tokens.end(), std::make_move_iterator(piece.begin()), std::make_move_iterator(piece.end()));
+	for (auto character : scanner.UnexpectedCharacters())
+	{
+		character.offset += scanned;
+		unexpected.push_back(character);
+	}
+	scanned += scanner.Scanned();
+	line = scanner.Line();
+	return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <istream>
+#include <string>
+#include <vector>
+#include "Token.h"
+#include "Scanner.h"
+
+//reads a script from a stream a chunk at a time and hands it out one top-level statement at a
+//time, for Lox::RunStream. only the statement being handed out, the tokens scanned after it and
+//the chunk they came from are kept, so memory stays bounded by the largest statement however long
+//the script is.
+//
+//statements are cut on tokens, before parsing: a statement ends with a ';' or a '}' outside of
+//any braces, unless an 'else' follows. a cut that comes out wrong on a broken script only changes
+//which syntax errors the Parser reports
+class StatementStream
+{
+public:
+	explicit StatementStream(std::istream& input, size_t chunkSize = 1 << 16)
+		: input(input), chunkSize(chunkSize) {}
+
+	//the tokens of the next statement followed by END_OF_FILE, for a Parser. false once the script
+	//is used up. the lexemes point into the stream and are valid until the next call
+	bool Next(std::vector<Token>& statement);
+	//lines of the unexpected characters in the statement Next handed out last, for Lox::Error
+	const std::vector<int>& UnexpectedCharacters() const { return unexpectedLines; }
+
+	//see Scanner::SetInterning
+	void SetInterning(bool intern) { this->intern = intern; }
+
+private:
+	//one past the last token of the statement starting at next, 0 while it is not all scanned yet
+	size_t StatementEnd();
+	//drops what has been handed out and scans another chunk, false at the end of the input
+	bool Fill();
+
+	std::istream& input;
+	size_t chunkSize;
+	bool inputEnded = false;
+	bool intern = true;
+
+	//the source from the first token not handed out yet; only up to scanned has been scanned,
+	//starting on line
+	std::string buffer;
+	size_t scanned = 0;
+	int line = 1;
+
+	std::vector<Token> tokens;
+	size_t next = 0;
+	//offsets into the buffer, reported up to the first one in a statement not handed out yet
+	std::vector<Scanner::UnexpectedCharacter> unexpected;
+	size_t reported = 0;
+	std::vector<int> unexpectedLines;
+	//how far StatementEnd got looking for the end of the statement at next, and the brace depth there
+	size_t searched = 0;
+	int depth = 0;
+};
@@ -11,6 +11,8 @@ public:
 	virtual void Accept(Visitor& visitor) = 0;
 };
 
+using StmtPtr = ArenaPtr<Stmt>;
+
 struct Stmt::Visitor
 {
 	virtual void VisitExpressionStmt(class ExpressionStmt& stmt) = 0;
@@ -24,9 +26,9 @@ struct Stmt::Visitor
 class ExpressionStmt : public Stmt
 {
 public:
-	std::unique_ptr<Expr> expression;
+	ExprPtr expression;
 
-	ExpressionStmt(std::unique_ptr<Expr> expression)
+	ExpressionStmt(ExprPtr expression)
 		: expression(std::move(expression)) {}
 
 	void Accept(Visitor& visitor) override { visitor.VisitExpressionStmt(*this); }
@@ -35,9 +37,9 @@ public:
 class PrintStmt : public Stmt
 {
 	public:
-	std::unique_ptr<Expr> expression;
+	ExprPtr expression;
 
-	PrintStmt(std::unique_ptr<Expr> expression)
+	PrintStmt(ExprPtr expression)
 		: expression(std::move(expression)) {}
 
 	void Accept(Visitor& visitor) override { visitor.VisitPrintStmt(*this); }
@@ -47,9 +49,10 @@ class VarStmt : public Stmt
 {
 public:
 	Token name;
-	std::unique_ptr<Expr> initializer; //can be null
+	ExprPtr initializer; //can be null
+	int slot = -1; //slot in the block's environment, -1 for globals
 
-	VarStmt(const Token& name, std::unique_ptr<Expr> initializer)
+	VarStmt(const Token& name, ExprPtr initializer)
 		: name(name), initializer(std::move(initializer)) {}
 
 	void Accept(Visitor& visitor) override { visitor.VisitVarStmt(*this); }
@@ -58,9 +61,10 @@ public:
 class BlockStmt : public Stmt
 {
 public:
-	std::vector<std::unique_ptr<Stmt>> statements;
+	std::vector<StmtPtr> statements;
+	int slotCount = 0; //number of distinct variables declared directly in the block, 0 means it gets no environment
 
-	BlockStmt(std::vector<std::unique_ptr<Stmt>> statements)
+	BlockStmt(std::vector<StmtPtr> statements)
 		: statements(std::move(statements)) {}
 
 	void Accept(Visitor& visitor) override { visitor.VisitBlockStmt(*this); }
@@ -69,11 +73,12 @@ public:
 class IfStmt : public Stmt
 {
 public:
-	std::unique_ptr<Expr> condition;
-	std::unique_ptr<Stmt> thenBranch;
-	std::unique_ptr<Stmt> elseBranch;
+	ExprPtr condition;
+	StmtPtr thenBranch;
+	StmtPtr elseBranch;
+	CompareExpr* compare = nullptr; //the condition, when the Fuser made it a CompareExpr
 
-	IfStmt(std::unique_ptr<Expr> condition, std::unique_ptr<Stmt> thenBranch, std::unique_ptr<Stmt> elseBranch)
+	IfStmt(ExprPtr condition, StmtPtr thenBranch, StmtPtr elseBranch)
 		: condition(std::move(condition)), thenBranch(std::move(thenBranch)), elseBranch(std::move(elseBranch)) {};
 
 	void Accept(Visitor& visitor) override { visitor.VisitIfStmt(*this); }
@@ -82,10 +87,11 @@ public:
 class WhileStmt : public Stmt
 {
 public:
-	std::unique_ptr<Expr> condition;
-	std::unique_ptr<Stmt> body;
+	ExprPtr condition;
+	StmtPtr body;
+	CompareExpr* compare = nullptr; //the condition, when the Fuser made it a CompareExpr
 
-	WhileStmt(std::unique_ptr<Expr> condition, std::unique_ptr<Stmt> body)
+	WhileStmt(ExprPtr condition, StmtPtr body)
 		: condition(std::move(condition)), body(std::move(body)) {};
 	void Accept(Visitor& visitor) override { visitor.VisitWhileStmt(*this); }
 };
\ No newline at end of file
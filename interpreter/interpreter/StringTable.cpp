@@ -0,0 +1,31 @@
+#include "StringTable.h"
+
+#ifndef LOX_VARIANT_VALUES
+
+StringTable& StringTable::Instance()
+{
+	static StringTable table;
+	return table;
+}
+
+LoxString* StringTable::Intern(std::string_view chars)
+{
+	auto iter = strings.find(chars);
+	if (iter != strings.end())
+	{
+		return iter->second;
+	}
+
+	auto string = new LoxString(std::string(chars));
+	string->interned = true;
+	string->Hash();
+	strings.emplace(string->Chars(), string);
+	return string;
+}
+
+void StringTable::Remove(LoxString* string)
+{
+	strings.erase(string->Chars());
+}
+
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+#include "Value.h"
+#include <string_view>
+#include <unordered_map>
+
+#ifndef LOX_VARIANT_VALUES
+
+//weak set of all interned strings. a string stays in the table while any value refers to
+//it and removes itself when its reference count drops to zero.
+class StringTable
+{
+public:
+	static StringTable& Instance();
+
+	LoxString* Intern(std::string_view chars);
+	void Remove(LoxString* string);
+	size_t Count() const { return strings.size(); }
+
+private:
+	StringTable() = default;
+
+	//keys view the chars of the string they map to, which is why interned strings are never extended in place
+	std::unordered_map<std::string_view, LoxString*> strings;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned threads)
+{
+	for (unsigned i = 1; i < threads; ++i)
+	{
+		workers.emplace_back([this]() { Work(); });
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (auto& worker : workers) worker.join();
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->task = &task;
+		this->count = count;
+		next = 0;
+		busy = workers.size();
+		++loop;
+	}
+	wake.notify_all();
+	RunTasks(task, count);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this]() { return busy == 0; });
+}
+
+void ThreadPool::Work()
+{
+	size_t joined = 0;
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;)
+	{
+		wake.wait(lock, [&]() { return stopping || loop != joined; });
+		if (stopping) return;
+		joined = loop;
+		const std::function<void(size_t)>& task = *this->task;
+		size_t count = this->count;
+		lock.unlock();
+		RunTasks(task, count);
+		lock.lock();
+		if (--busy == 0) done.notify_one();
+	}
+}
+
+void ThreadPool::RunTasks(const std::function<void(size_t)>& task, size_t count)
+{
+	for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+	{
+		task(i);
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//fixed set of threads that run the iterations of a parallel loop. the thread that calls
+//ParallelFor takes part in it, so a pool of n threads starts n - 1 workers, which sleep between
+//loops. iterations are handed out one at a time as threads become free
+class ThreadPool
+{
+public:
+	explicit ThreadPool(unsigned threads);
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	~ThreadPool();
+
+	unsigned Size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+	//calls task(i) for every i below count and returns once all of them are done
+	void ParallelFor(size_t count, const std::function<void(size_t)>& task);
+
+private:
+	void Work();
+	void RunTasks(const std::function<void(size_t)>& task, size_t count);
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	//the current loop, its number tells a worker whether it has joined it yet
+	const std::function<void(size_t)>* task = nullptr;
+	size_t count = 0;
+	size_t loop = 0;
+	std::atomic<size_t> next{ 0 };
+	//workers that have not finished the current loop
+	size_t busy = 0;
+	bool stopping = false;
+};
@@ -1,37 +1,26 @@
 #pragma once
 #include "TokenType.h"
 #include <string>
-#include <variant>
-
-using LoxValue = std::variant<std::monostate, double, std::string, bool>;
+#include <string_view>
+#include "Value.h"
 
 struct Token
 {
+	//ordered so the token packs into 32 bytes
 	TokenType type;
-	std::string lexeme;
-	LoxValue lit;
 	int line;
+	std::string_view lexeme; //views the scanner's source, or the parse Arena for tokens kept in the AST
+	LoxValue lit;
 
-	Token(TokenType type, const std::string lexeme, LoxValue literal, int line)
-		: type(type), lexeme(lexeme), lit(lit), line(line) {}
-	Token(TokenType type, const std::string lexeme, double num, int line)
-		: type(type), lexeme(lexeme), lit(num), line(line) {}
-	Token(TokenType type, const std::string lexeme, std::string str, int line)
-		: type(type), lexeme(lexeme), lit(str), line(line) {}
-	Token(TokenType type, const std::string lexeme, bool bol, int line)
-		: type(type), lexeme(lexeme), lit(bol), line(line) {}
+	Token(TokenType type, std::string_view lexeme, LoxValue literal, int line)
+		: type(type), line(line), lexeme(lexeme), lit(std::move(literal)) {}
 	std::string ToString() const
 	{
-		return lexeme + " " + std::visit([](auto&& arg) -> std::string {
-			using T = std::decay_t<decltype(arg)>;
-			if constexpr (std::is_same_v<T, std::monostate>)
-				return "nil";
-			else if constexpr (std::is_same_v<T, double>)
-				return std::to_string(arg);
-			else if constexpr (std::is_same_v<T, std::string>)
-				return arg;
-			else
-				return "unknown";
-		}, lit);
+		std::string text;
+		if (IsNil(lit)) text = "nil";
+		else if (IsNumber(lit)) text = std::to_string(AsNumber(lit));
+		else if (IsString(lit)) text = AsString(lit);
+		else text = "unknown";
+		return std::string(lexeme) + " " + text;
 	}
 };
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "VM.h"
+#include <iostream>
+
+bool VM::Interpret(const Chunk& chunk)
+{
+	bool completed = true;
+	try
+	{
+		Run(chunk);
+	}
+	catch (const RuntimeError& error)
+	{
+		output.Flush();
+		std::cerr << "[line " << error.getToken().line << "] RuntimeError: "
+			<< error.what() << "\n";
+		completed = false;
+	}
+	stack.clear();
+	return completed;
+}
+
+void VM::Run(const Chunk& chunk)
+{
+	const uint8_t* ip = chunk.code.data();
+
+	auto readByte = [&]() { return *ip++; };
+	auto readShort = [&]() { ip += 2; return static_cast<uint16_t>((ip[-2] << 8) | ip[-1]); };
+	auto readLong = [&]() { ip += 3; return static_cast<uint32_t>((ip[-3] << 16) | (ip[-2] << 8) | ip[-1]); };
+	//the short and the long form of an instruction share a case, this reads the operand of either
+	auto readOperand = [&](OpCode shortForm) {
+		return static_cast<OpCode>(ip[-1]) == shortForm ? uint32_t{ readShort() } : readLong();
+	};
+	auto pop = [&]() { LoxValue value = std::move(stack.back()); stack.pop_back(); return value; };
+	auto bothNumbers = [&]() {
+		return IsNumber(stack[stack.size() - 2]) && IsNumber(stack.back());
+	};
+
+	for (;;)
+	{
+		switch (static_cast<OpCode>(readByte()))
+		{
+		case OpCode::CONSTANT:
+		case OpCode::CONSTANT_LONG:
+			stack.push_back(chunk.constants[readOperand(OpCode::CONSTANT)]);
+			break;
+		case OpCode::NIL: stack.emplace_back(); break;
+		case OpCode::TRUE: stack.emplace_back(true); break;
+		case OpCode::FALSE: stack.emplace_back(false); break;
+		case OpCode::POP: stack.pop_back(); break;
+		case OpCode::GET_LOCAL:
+			stack.push_back(stack[readByte()]);
+			break;
+		case OpCode::SET_LOCAL:
+			//assignment is an expression, so the value stays on the stack
+			stack[readByte()] = stack.back();
+			break;
+		case OpCode::GET_GLOBAL:
+		case OpCode::GET_GLOBAL_LONG:
+		{
+			const LoxValue& name = chunk.constants[readOperand(OpCode::GET_GLOBAL)];
+			auto iter = globals.find(name);
+			if (iter == globals.end())
+			{
+				throw Error(chunk, ip, "undefined variable '" + std::string(AsString(name)) + "'.");
+			}
+			stack.push_back(iter->second);
+			break;
+		}
+		case OpCode::DEFINE_GLOBAL:
+		case OpCode::DEFINE_GLOBAL_LONG:
+			globals[chunk.constants[readOperand(OpCode::DEFINE_GLOBAL)]] = pop();
+			break;
+		case OpCode::SET_GLOBAL:
+		case OpCode::SET_GLOBAL_LONG:
+		{
+			const LoxValue& name = chunk.constants[readOperand(OpCode::SET_GLOBAL)];
+			auto iter = globals.find(name);
+			if (iter == globals.end())
+			{
+				throw Error(chunk, ip, "undefined variable '" + std::string(AsString(name)) + "'.");
+			}
+			iter->second = stack.back();
+			break;
+		}
+		case OpCode::EQUAL:
+		{
+			LoxValue b = pop();
+			stack.back() = IsEqual(stack.back(), b);
+			break;
+		}
+		case OpCode::NOT_EQUAL:
+		{
+			LoxValue b = pop();
+			stack.back() = !IsEqual(stack.back(), b);
+			break;
+		}
+		case OpCode::GREATER:
+		case OpCode::GREATER_EQUAL:
+		case OpCode::LESS:
+		case OpCode::LESS_EQUAL:
+		{
+			if (!bothNumbers()) throw Error(chunk, ip, "Operands must be numbers.");
+			double b = AsNumber(pop());
+			double a = AsNumber(stack.back());
+			switch (static_cast<OpCode>(ip[-1]))
+			{
+			case OpCode::GREATER: stack.back() = a > b; break;
+			case OpCode::GREATER_EQUAL: stack.back() = a >= b; break;
+			case OpCode::LESS: stack.back() = a < b; break;
+			default: stack.back() = a <= b; break;
+			}
+			break;
+		}
+		case OpCode::ADD:
+		{
+			if (bothNumbers())
+			{
+				double b = AsNumber(pop());
+				stack.back() = AsNumber(stack.back()) + b;
+			}
+			else if (IsString(stack[stack.size() - 2]) && IsString(stack.back()))
+			{
+				LoxValue b = pop();
+				stack.back() = Concatenate(stack.back(), b);
+			}
+			else
+			{
+				throw Error(chunk, ip, "Operands must be two numbers or two strings.");
+			}
+			break;
+		}
+		case OpCode::SUBTRACT:
+		case OpCode::MULTIPLY:
+		case OpCode::DIVIDE:
+		{
+			if (!bothNumbers()) throw Error(chunk, ip, "Operands must be numbers.");
+			OpCode op = static_cast<OpCode>(ip[-1]);
+			double b = AsNumber(pop());
+			double a = AsNumber(stack.back());
+			if (op == OpCode::SUBTRACT) stack.back() = a - b;
+			else if (op == OpCode::MULTIPLY) stack.back() = a * b;
+			else
+			{
+				if (b == 0) throw Error(chunk, ip, "Division by zero.");
+				stack.back() = a / b;
+			}
+			break;
+		}
+		case OpCode::NOT:
+			stack.back() = !IsTruthy(stack.back());
+			break;
+		case OpCode::NEGATE:
+			if (!IsNumber(stack.back())) throw Error(chunk, ip, "Operand must be a number.");
+			stack.back() = -AsNumber(stack.back());
+			break;
+		case OpCode::PRINT:
+			output.Print(pop());
+			break;
+		case OpCode::JUMP:
+		case OpCode::JUMP_LONG:
+		{
+			uint32_t offset = readOperand(OpCode::JUMP);
+			ip += offset;
+			break;
+		}
+		case OpCode::JUMP_IF_FALSE:
+		case OpCode::JUMP_IF_FALSE_LONG:
+		{
+			//the condition stays on the stack, the compiler emits the pops
+			uint32_t offset = readOperand(OpCode::JUMP_IF_FALSE);
+			if (!IsTruthy(stack.back())) ip += offset;
+			break;
+		}
+		case OpCode::LOOP:
+		case OpCode::LOOP_LONG:
+		{
+			uint32_t offset = readOperand(OpCode::LOOP);
+			ip -= offset;
+			break;
+		}
+		case OpCode::RETURN:
+			return;
+		}
+	}
+}
+
+RuntimeError VM::Error(const Chunk& chunk, const uint8_t* ip, const std::string& message) const
+{
+	//ip has already moved past the failing instruction, any offset inside it maps to its line
+	size_t offset = static_cast<size_t>(ip - chunk.code.data()) - 1;
+	return RuntimeError(chunk.GetLine(offset), message);
+}
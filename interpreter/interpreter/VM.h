@@ -0,0 +1,27 @@
+#pragma once
+#include "Chunk.h"
+#include "RuntimeError.h"
+#include "OutputSink.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//stack based virtual machine that executes chunks produced by the Compiler.
+//globals persist between calls so the REPL keeps its variables.
+class VM
+{
+public:
+	explicit VM(OutputSink& output = StandardOutput()) : output(output) { stack.reserve(256); }
+
+	//false when a runtime error stopped the chunk
+	bool Interpret(const Chunk& chunk);
+
+private:
+	void Run(const Chunk& chunk);
+	RuntimeError Error(const Chunk& chunk, const uint8_t* ip, const std::string& message) const;
+
+	OutputSink& output;
+	std::vector<LoxValue> stack;
+	//keyed by the interned variable name
+	std::unordered_map<LoxValue, LoxValue, LoxValueHash, LoxValueEqual> globals;
+};
@@ -0,0 +1,129 @@
+#include "Value.h"
+#include "StringTable.h"
+#include <algorithm>
+#include <charconv>
+
+#ifdef LOX_VARIANT_VALUES
+
+LoxValue InternString(std::string_view chars)
+{
+	return std::string(chars);
+}
+
+LoxValue Concatenate(const LoxValue& a, const LoxValue& b)
+{
+	return AsString(a) + AsString(b);
+}
+
+static bool StringsEqual(const LoxValue& a, const LoxValue& b)
+{
+	return AsString(a) == AsString(b);
+}
+
+size_t LoxValueHash::operator()(const LoxValue& value) const
+{
+	return std::hash<LoxValue>{}(value);
+}
+
+#else
+
+void FreeString(LoxString* string)
+{
+	if (string->interned)
+	{
+		StringTable::Instance().Remove(string);
+	}
+	delete string;
+}
+
+LoxValue InternString(std::string_view chars)
+{
+	return LoxValue(StringTable::Instance().Intern(chars));
+}
+
+LoxValue Concatenate(const LoxValue& a, const LoxValue& b)
+{
+	LoxString* left = a.AsObject();
+	LoxString* right = b.AsObject();
+	//the result shares left's buffer when left views all of it. appending chars of the same
+	//buffer could move them while they are read, so that case is copied like any other
+	if (left->AtEnd() && right->buffer != left->buffer)
+	{
+		left->buffer->chars.append(right->Chars());
+		return LoxValue(new LoxString(left->buffer));
+	}
+
+	std::string chars;
+	chars.reserve(left->length + right->length);
+	chars.append(left->Chars()).append(right->Chars());
+	return LoxValue(std::move(chars));
+}
+
+static bool StringsEqual(const LoxValue& a, const LoxValue& b)
+{
+	LoxString* left = a.AsObject();
+	LoxString* right = b.AsObject();
+	if (left == right) return true;
+	//two distinct interned strings never have the same content
+	if (left->interned && right->interned) return false;
+	if (left->length != right->length) return false;
+	return left->Hash() == right->Hash() && left->Chars() == right->Chars();
+}
+
+size_t LoxValueHash::operator()(const LoxValue& value) const
+{
+	if (IsString(value)) return value.AsObject()->Hash();
+	if (IsNumber(value)) return std::hash<double>{}(AsNumber(value));
+	if (IsBool(value)) return AsBool(value) ? 1 : 2;
+	return 0;
+}
+
+#endif
+
+bool LoxValueEqual::operator()(const LoxValue& a, const LoxValue& b) const
+{
+	return IsEqual(a, b);
+}
+
+bool IsTruthy(const LoxValue& value)
+{
+	if (IsNil(value)) return false;
+	if (IsBool(value)) return AsBool(value);
+	return true;
+}
+
+bool IsEqual(const LoxValue& a, const LoxValue& b)
+{
+	//numbers compare by value so that 0 == -0 and NaN != NaN
+	if (IsNumber(a) && IsNumber(b)) return AsNumber(a) == AsNumber(b);
+	if (IsString(a) && IsString(b)) return StringsEqual(a, b);
+	if (IsNil(a) && IsNil(b)) return true;
+	if (IsBool(a) && IsBool(b)) return AsBool(a) == AsBool(b);
+	return false;
+}
+
+void AppendStringified(std::string& out, const LoxValue& value)
+{
+	if (IsNumber(value))
+	{
+		//six decimals like std::to_string, without its allocation, then drop the trailing zeros
+		char text[400]; //enough for the largest double in fixed notation
+		char* end = std::to_chars(text, text + sizeof text, AsNumber(value), std::chars_format::fixed, 6).ptr;
+		if (std::find(text, end, '.') != end)
+		{
+			while (end[-1] == '0') --end;
+			if (end[-1] == '.') --end;
+		}
+		out.append(text, end);
+	}
+	else if (IsString(value)) out += AsString(value);
+	else if (IsBool(value)) out += AsBool(value) ? "true" : "false";
+	else out += "nil";
+}
+
+std::string Stringify(const LoxValue& value)
+{
+	std::string text;
+	AppendStringified(text, value);
+	return text;
+}
@@ -0,0 +1,188 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <functional>
+
+//runtime value of lox. shared by the scanner (literals), the treewalk interpreter and the vm.
+//by default a value is a NaN-boxed 64 bit word: doubles are stored as themselves, nil/true/false
+//are tagged quiet NaNs and strings are a pointer to a heap LoxString packed into the NaN payload.
+//define LOX_VARIANT_VALUES to build with the original std::variant representation instead.
+//code outside this file should only use the Is*/As* helpers so it works with both. AsString
+//gives a const std::string& in one and a std::string_view in the other, treat it as a view.
+
+#ifdef LOX_VARIANT_VALUES
+
+using LoxValue = std::variant<std::monostate, double, std::string, bool>;
+
+inline bool IsNil(const LoxValue& value) { return std::holds_alternative<std::monostate>(value); }
+inline bool IsBool(const LoxValue& value) { return std::holds_alternative<bool>(value); }
+inline bool IsNumber(const LoxValue& value) { return std::holds_alternative<double>(value); }
+inline bool IsString(const LoxValue& value) { return std::holds_alternative<std::string>(value); }
+inline bool AsBool(const LoxValue& value) { return std::get<bool>(value); }
+inline double AsNumber(const LoxValue& value) { return std::get<double>(value); }
+inline const std::string& AsString(const LoxValue& value) { return std::get<std::string>(value); }
+
+#else
+
+//characters shared by the strings that + makes from one another. every string views a prefix of
+//its buffer and the buffer only ever grows, so the string that views all of it can be extended
+//in place: s = s + piece appends to s's buffer instead of copying s.
+struct StringBuffer
+{
+	explicit StringBuffer(std::string chars) : chars(std::move(chars)) {}
+
+	std::string chars;
+	int refCount = 0;
+};
+
+//immutable string payload shared between values by reference counting.
+//interned strings are unique per content (see StringTable), so two of them are equal
+//exactly when they are the same object.
+struct LoxString
+{
+	explicit LoxString(std::string chars) : LoxString(new StringBuffer(std::move(chars))) {}
+	//the first length characters of buffer
+	LoxString(StringBuffer* buffer, size_t length) : buffer(buffer), length(length) { buffer->refCount++; }
+	explicit LoxString(StringBuffer* buffer) : LoxString(buffer, buffer->chars.size()) {}
+	LoxString(const LoxString&) = delete;
+	LoxString& operator=(const LoxString&) = delete;
+	~LoxString()
+	{
+		if (--buffer->refCount == 0) delete buffer;
+	}
+
+	std::string_view Chars() const { return std::string_view(buffer->chars.data(), length); }
+
+	//appending to this string can write into its buffer. interned strings are never extended,
+	//the StringTable keys view their chars
+	bool AtEnd() const { return !interned && length == buffer->chars.size(); }
+
+	size_t Hash() const
+	{
+		if (!hashed)
+		{
+			hash = std::hash<std::string_view>{}(Chars());
+			hashed = true;
+		}
+		return hash;
+	}
+
+	StringBuffer* const buffer;
+	const size_t length;
+	int refCount = 0;
+	bool interned = false;
+
+private:
+	mutable size_t hash = 0;
+	mutable bool hashed = false;
+};
+
+//frees a string whose last reference went away
+void FreeString(LoxString* string);
+
+class LoxValue
+{
+public:
+	LoxValue() : bits(NIL_VALUE) {}
+	LoxValue(double number) { std::memcpy(&bits, &number, sizeof number); }
+	LoxValue(bool boolean) : bits(boolean ? TRUE_VALUE : FALSE_VALUE) {}
+	LoxValue(std::string string) : LoxValue(new LoxString(std::move(string))) {}
+	LoxValue(const char* string) : LoxValue(std::string(string)) {}
+	explicit LoxValue(LoxString* string) : bits(SIGN_BIT | QNAN | static_cast<uint64_t>(reinterpret_cast<uintptr_t>(string)))
+	{
+		string->refCount++;
+	}
+
+	LoxValue(const LoxValue& other) : bits(other.bits) { Retain(); }
+	LoxValue(LoxValue&& other) noexcept : bits(other.bits) { other.bits = NIL_VALUE; }
+	LoxValue& operator=(const LoxValue& other)
+	{
+		other.Retain();
+		Release();
+		bits = other.bits;
+		return *this;
+	}
+	LoxValue& operator=(LoxValue&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Release();
+			bits = other.bits;
+			other.bits = NIL_VALUE;
+		}
+		return *this;
+	}
+	~LoxValue() { Release(); }
+
+	bool IsNil() const { return bits == NIL_VALUE; }
+	bool IsBool() const { return (bits | 1) == TRUE_VALUE; }
+	//anything that is not one of our tagged NaNs is a double, including real NaNs
+	bool IsNumber() const { return (bits & QNAN) != QNAN; }
+	bool IsString() const { return (bits & (QNAN | SIGN_BIT)) == (QNAN | SIGN_BIT); }
+
+	bool AsBool() const { return bits == TRUE_VALUE; }
+	double AsNumber() const
+	{
+		double number;
+		std::memcpy(&number, &bits, sizeof number);
+		return number;
+	}
+	LoxString* AsObject() const { return reinterpret_cast<LoxString*>(static_cast<uintptr_t>(bits & ~(SIGN_BIT | QNAN))); }
+
+private:
+	static constexpr uint64_t SIGN_BIT = 0x8000000000000000;
+	static constexpr uint64_t QNAN = 0x7ffc000000000000;
+	static constexpr uint64_t NIL_VALUE = QNAN | 1;
+	static constexpr uint64_t FALSE_VALUE = QNAN | 2;
+	static constexpr uint64_t TRUE_VALUE = QNAN | 3;
+
+	void Retain() const
+	{
+		if (IsString()) AsObject()->refCount++;
+	}
+	void Release()
+	{
+		if (IsString() && --AsObject()->refCount == 0) FreeString(AsObject());
+	}
+
+	uint64_t bits;
+};
+
+static_assert(sizeof(LoxValue) == 8, "LoxValue should be a single NaN-boxed word");
+
+inline bool IsNil(const LoxValue& value) { return value.IsNil(); }
+inline bool IsBool(const LoxValue& value) { return value.IsBool(); }
+inline bool IsNumber(const LoxValue& value) { return value.IsNumber(); }
+inline bool IsString(const LoxValue& value) { return value.IsString(); }
+inline bool AsBool(const LoxValue& value) { return value.AsBool(); }
+inline double AsNumber(const LoxValue& value) { return value.AsNumber(); }
+inline std::string_view AsString(const LoxValue& value) { return value.AsObject()->Chars(); }
+
+#endif
+
+//returns the shared string for this content, used for literals and identifiers
+LoxValue InternString(std::string_view chars);
+//result of the + operator on two strings
+LoxValue Concatenate(const LoxValue& a, const LoxValue& b);
+
+//hash and equality for maps keyed by values, e.g. globals keyed by their interned name
+struct LoxValueHash
+{
+	size_t operator()(const LoxValue& value) const;
+};
+
+struct LoxValueEqual
+{
+	bool operator()(const LoxValue& a, const LoxValue& b) const;
+};
+
+//nil and false are falsey, everything else is truthy
+bool IsTruthy(const LoxValue& value);
+bool IsEqual(const LoxValue& a, const LoxValue& b);
+//text printed by the print statement
+std::string Stringify(const LoxValue& value);
+//same text, appended to out without a temporary string
+void AppendStringified(std::string& out, const LoxValue& value);
@@ -1,21 +1,93 @@
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <string>
 #include "Lox.h"
 
 int main(int argc, char* argv[])
 {
-    Lox lox;
+    //print output goes through OutputSink, which does its own buffering
+    std::ios::sync_with_stdio(false);
 
-    if (argc > 2)
+    LoxOptions options;
+    std::string path;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--vm")
+        {
+            options.engine = Engine::Bytecode;
+        }
+        else if (arg == "--closures")
+        {
+            options.engine = Engine::Closures;
+        }
+        else if (arg == "--dump-ast")
+        {
+            options.dumpAst = true;
+        }
+        else if (arg == "--timings")
+        {
+            options.timings = true;
+        }
+        else if (arg == "--cache")
+        {
+            options.astCache = true;
+        }
+        else if (arg == "--profile")
+        {
+            options.profile = true;
+        }
+        else if (arg == "--instrument")
+        {
+            options.instrument = true;
+        }
+        else if (arg == "--instrument-time")
+        {
+            options.instrument = true;
+            options.instrumentTime = true;
+        }
+        else if (arg == "--stream")
+        {
+            options.stream = true;
+        }
+        else if (arg == "--pipeline")
+        {
+            options.stream = true;
+            options.pipeline = true;
+        }
+        else if (arg == "--scan-threads" && i + 1 < argc)
+        {
+            options.scanThreads = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        }
+        else if (arg == "--ic-stats")
+        {
+            options.cacheStats = true;
+        }
+        else if (path.empty() && arg.rfind("--", 0) != 0)
+        {
+            path = arg;
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--vm | --closures] [--dump-ast] [--ic-stats] [--timings] [--cache] [--profile] [--instrument | --instrument-time] [--stream | --pipeline] [--scan-threads n] [optional_argument]\n";
+            return 1;
+        }
+    }
+
+    Lox lox(options);
+    if (!path.empty())
     {
-		std::cerr << "Usage: " << argv[0] << " [optional_argument]\n";
-		return 1;
+        lox.RunFile(path);
     }
-    else if (argc == 2)
+    else if (options.stream)
     {
-        lox.RunFile(argv[1]);
+        //a script piped in, instead of the prompt
+        lox.RunStream(std::cin);
     }
     else
     {
         lox.RunPrompt();
     }
-}
+}
\ No newline at end of file
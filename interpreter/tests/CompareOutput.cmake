@@ -0,0 +1,7 @@
+# runs SCRIPT through INTERPRETER with MODE and compares what it writes to stdout and stderr,
+# interleaved as it was written, with EXPECTED
+execute_process(COMMAND ${INTERPRETER} ${MODE} ${SCRIPT} OUTPUT_VARIABLE output ERROR_VARIABLE output)
+file(READ ${EXPECTED} expected)
+if(NOT output STREQUAL expected)
+	message(FATAL_ERROR "${SCRIPT} with ${MODE} printed\n${output}\ninstead of\n${expected}")
+endif()